@@ -81,7 +81,6 @@ std::ostream &operator<<(std::ostream &os, const std::vector<T> &vec) {
                   << __LINE__ << "] [" << func << "] " << out_format << std::endl;                                   \
     }
 #define debug_func(out_format)                                                       \
-    dmz_profile_function();                                                          \
     auto ____func_name = __func__;                                                   \
     debug_msg("BEGIN " << ____func_name << " " << out_format);                       \
     debug_lock::get_count()++;                                                       \
@@ -93,21 +92,13 @@ std::ostream &operator<<(std::ostream &os, const std::vector<T> &vec) {
 #define debug_ret(ret) ret
 #define debug_msg(out_format)
 #define debug_msg_func(func, out_format)
-#define debug_func(out_format) dmz_profile_function();
+#define debug_func(out_format)
 #endif
 
-#ifdef DMZ_SINGLE_THREADED
 #define println(out_format)                                                  \
     {                                                                        \
         std::unique_lock internal_debug_lock(::DMZ::debug_lock::get_lock()); \
         std::cout << std::dec << out_format << std::endl;                    \
     }
-#else  // DMZ_SINGLE_THREADED
-#define println(out_format)                                                                            \
-    {                                                                                                  \
-        std::unique_lock internal_debug_lock(::DMZ::debug_lock::get_lock());                           \
-        std::cout << "[" << std::this_thread::get_id() << "] " << std::dec << out_format << std::endl; \
-    }
-#endif  // DMZ_SINGLE_THREADED
 #define TODO(msg) assert(false && "TODO" && msg)
 }  // namespace DMZ
@@ -5,147 +5,153 @@
 namespace DMZ {
 
 struct profiler_data {
-    pid_t m_pid;
-    std::thread::id m_tid;
     std::variant<const char*, std::string> m_name;
-    uint32_t m_start;
-    uint32_t m_duration;
-
-    profiler_data(pid_t pid, std::thread::id tid, std::variant<const char*, std::string> name, uint32_t start,
-                  uint32_t duration)
-        : m_pid(pid), m_tid(tid), m_name(name), m_start(start), m_duration(duration) {}
+    std::string m_detail;
+    uint64_t m_start;
+    uint64_t m_duration;
+
+    profiler_data(std::variant<const char*, std::string> name, std::string detail, uint64_t start, uint64_t duration)
+        : m_name(std::move(name)), m_detail(std::move(detail)), m_start(start), m_duration(duration) {}
+
+    static void dump_string(std::ostream& json, std::string_view str) {
+        json << '"';
+        for (char c : str) {
+            if (c == '"' || c == '\\') {
+                json << '\\' << c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                json << ' ';
+            } else {
+                json << c;
+            }
+        }
+        json << '"';
+    }
 
-    void dump_data(std::ostream& json) const {
+    void dump_data(std::ostream& json, pid_t pid, size_t tid) const {
         json << ",{";
         json << "\"cat\":\"function\",";
         json << "\"dur\":" << m_duration << ',';
+        json << "\"name\":";
         if (std::holds_alternative<const char*>(m_name)) {
-            json << "\"name\":\"" << std::get<const char*>(m_name) << "\",";
+            dump_string(json, std::get<const char*>(m_name));
         } else {
-            json << "\"name\":\"" << std::get<std::string>(m_name) << "\",";
+            dump_string(json, std::get<std::string>(m_name));
+        }
+        json << ',';
+        if (!m_detail.empty()) {
+            json << "\"args\":{\"detail\":";
+            dump_string(json, m_detail);
+            json << "},";
         }
         json << "\"ph\":\"X\",";
-        json << "\"pid\":\"" << m_pid << "\",";
-        json << "\"tid\":" << m_tid << ",";
+        json << "\"pid\":" << pid << ',';
+        json << "\"tid\":" << tid << ',';
         json << "\"ts\":" << m_start;
         json << "}\n";
     }
 };
 
+// Chrome tracing profiler, enabled at runtime with -ftime-trace.
+// Every thread records its events in its own buffer without taking any lock, the buffers are registered once per
+// thread and merged into the trace file at end_session, that must be called when the other threads are idle.
 class profiler {
    public:
     profiler(const profiler&) = delete;
     profiler(profiler&&) = delete;
 
+    static bool enabled() { return get_instance().m_enabled.load(std::memory_order_relaxed); }
+
     void begin_session(const std::string& name) {
         std::lock_guard lock(m_mutex);
-        m_buffer = std::vector<profiler_data>();
-        m_buffer.reserve(m_buffer_cap);
         m_current_session_file = name;
-
-        std::ofstream archivo_salida(m_current_session_file, std::ios::out);
-
-        if (archivo_salida.is_open()) {
-            archivo_salida << get_header();
-            archivo_salida.close();
-        } else {
-            std::cerr << "ERROR: Could not open file " << m_current_session_file << " for writing.\n";
+        m_session_start = std::chrono::steady_clock::now();
+        for (auto& buffer : m_buffers) {
+            buffer->events.clear();
         }
+        m_enabled = true;
     }
 
     void end_session() {
         std::lock_guard lock(m_mutex);
-        if (m_buffer.size() > 0) {
-            save_data(std::move(m_buffer));
-        }
-        for (auto& fut : m_fut_save_data) {
-            if (fut.valid()) {
-                fut.get();
-            }
-        }
-        std::ofstream archivo_salida(m_current_session_file, std::ios::out | std::ios::app);
+        if (!m_enabled) return;
+        m_enabled = false;
 
-        if (archivo_salida.is_open()) {
-            archivo_salida << get_footer();
-            archivo_salida.close();
-        } else {
+        std::ofstream archivo_salida(m_current_session_file, std::ios::out);
+        if (!archivo_salida.is_open()) {
             std::cerr << "ERROR: Could not open file " << m_current_session_file << " for writing.\n";
+            return;
         }
-    }
-
-    void write_profile(std::variant<const char*, std::string> name, uint32_t start, uint32_t duration) {
-        std::lock_guard lock(m_mutex);
-        if (!m_current_session_file.empty()) {
-            // debug_msg("Buffer size " << m_buffer.size());
-            m_buffer.emplace_back(getpid(), std::this_thread::get_id(), name, start, duration);
-
-            if (m_buffer.size() >= m_buffer_cap) {
-                save_data(std::move(m_buffer));
-                m_buffer = std::vector<profiler_data>();
-                m_buffer.reserve(m_buffer_cap);
+        archivo_salida << get_header();
+        pid_t pid = getpid();
+        for (auto& buffer : m_buffers) {
+            for (auto& data : buffer->events) {
+                data.dump_data(archivo_salida, pid, buffer->tid);
             }
+            buffer->events.clear();
         }
+        archivo_salida << get_footer();
+    }
+
+    void write_profile(std::variant<const char*, std::string> name, std::string detail,
+                       std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+        thread_buffer& buffer = get_thread_buffer();
+        auto since_start = std::chrono::duration_cast<std::chrono::microseconds>(start - m_session_start).count();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        buffer.events.emplace_back(std::move(name), std::move(detail), since_start, duration);
     }
 
     static std::string get_header() { return "{\"otherData\": {},\"traceEvents\":[{}\n"; }
     static std::string get_footer() { return "]}"; }
 
     static profiler& get_instance() {
-        static profiler instance;
-        return instance;
+        // Never destroyed, the threads can still record events while the program exits
+        static profiler* instance = new profiler();
+        return *instance;
     }
 
    private:
+    struct thread_buffer {
+        size_t tid;
+        std::vector<profiler_data> events;
+    };
+
     profiler() {}
-    ~profiler() {}
 
-    void save_data(const std::vector<profiler_data>&& message) {
-        m_fut_save_data.remove_if([](auto& fut) {
-            if (fut.valid() && fut.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
-                fut.get();
-                return true;
-            }
-            return false;
-        });
-        m_fut_save_data.push_back(
-            std::async(std::launch::async, [msg = std::move(message), current_session_file = m_current_session_file]() {
-                std::stringstream ss;
-                for (auto& data : msg) {
-                    data.dump_data(ss);
-                }
-                std::string str = ss.str();
-                // debug_msg("profiler send msgs " << msg.size() << " and " << str.size() << " str size");
-
-                std::ofstream archivo_salida(current_session_file, std::ios::out | std::ios::app);
-
-                if (archivo_salida.is_open()) {
-                    archivo_salida << str;
-                    archivo_salida.close();
-                    return 0;
-                } else {
-                    std::cerr << "ERROR: Could not open file " << current_session_file << " for writing.\n";
-                    return -1;
-                }
-                return 0;
-            }));
+    thread_buffer& get_thread_buffer() {
+        thread_local thread_buffer* t_buffer = nullptr;
+        if (!t_buffer) {
+            std::lock_guard lock(m_mutex);
+            auto& buffer = m_buffers.emplace_back(std::make_unique<thread_buffer>());
+            buffer->tid = m_buffers.size();
+            buffer->events.reserve(m_buffer_cap);
+            t_buffer = buffer.get();
+        }
+        return *t_buffer;
     }
 
    private:
     std::mutex m_mutex;
+    std::atomic<bool> m_enabled = false;
     std::string m_current_session_file = "";
-    std::list<std::future<int>> m_fut_save_data;
+    std::chrono::steady_clock::time_point m_session_start;
+    // Owned by the profiler so the events of the threads that already finished are kept
+    std::list<std::unique_ptr<thread_buffer>> m_buffers;
     constexpr static uint64_t m_buffer_cap = 1024;
-    std::vector<profiler_data> m_buffer;
 };
 
 class profiler_timer {
    public:
-    profiler_timer(const char* name) : m_name(name) { m_start_timepoint = std::chrono::high_resolution_clock::now(); }
+    profiler_timer(const char* name) : m_name(name) {
+        if (profiler::enabled()) start();
+    }
 
+    // The arguments are joined in the detail of the event, only when the profiler is enabled
     template <typename... Args>
-    profiler_timer(Args... args) {
-        m_start_timepoint = std::chrono::high_resolution_clock::now();
-        m_name_str = concatenate(args...);
+    profiler_timer(const char* name, const Args&... args) : m_name(name) {
+        if (profiler::enabled()) {
+            m_detail = concatenate(args...);
+            start();
+        }
     }
 
     template <typename T>
@@ -165,32 +171,33 @@ class profiler_timer {
     }
 
     ~profiler_timer() {
-        if (!m_stopped) Stop();
+        if (m_active) Stop();
     }
 
     void Stop() {
-        auto start =
-            std::chrono::duration_cast<std::chrono::microseconds>(m_start_timepoint.time_since_epoch()).count();
-        auto elapsed_time = std::chrono::duration_cast<std::chrono::microseconds>(
-                                std::chrono::high_resolution_clock::now() - m_start_timepoint)
-                                .count();
-        if (m_name == nullptr) {
-            profiler::get_instance().write_profile(m_name_str, start, elapsed_time);
-        } else {
-            profiler::get_instance().write_profile(m_name, start, elapsed_time);
-        }
-        m_stopped = true;
+        if (!m_active) return;
+        m_active = false;
+        if (!profiler::enabled()) return;
+        profiler::get_instance().write_profile(m_name, std::move(m_detail), m_start_timepoint,
+                                               std::chrono::steady_clock::now());
     }
 
    private:
+    void start() {
+        m_active = true;
+        m_start_timepoint = std::chrono::steady_clock::now();
+    }
+
     const char* m_name = nullptr;
-    std::string m_name_str;
-    std::chrono::time_point<std::chrono::high_resolution_clock> m_start_timepoint;
-    bool m_stopped = false;
+    std::string m_detail;
+    std::chrono::steady_clock::time_point m_start_timepoint;
+    bool m_active = false;
 };
 }  // namespace DMZ
 
-#define dmz_profile 0
+#ifndef dmz_profile
+#define dmz_profile 1
+#endif
 #if dmz_profile
 #define dmz_profile_begin_session(name)         ::DMZ::profiler::get_instance().begin_session(name)
 #define dmz_profile_end_session()               ::DMZ::profiler::get_instance().end_session()
@@ -211,4 +218,4 @@ class profiler_timer {
 
 #define dmz_profile_scope_args(name, ...)
 #define dmz_profile_function_args(...)
-#endif
\ No newline at end of file
+#endif
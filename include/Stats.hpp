@@ -1,49 +1,101 @@
 #pragma once
 
+#include <sys/resource.h>
+
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <iomanip>
 #include <iostream>
 #include <unordered_map>
 
+#include "Profiler.hpp"
 #include "Utils.hpp"
 #include "driver/Driver.hpp"
 
 namespace DMZ {
 enum class StatType : int {
+    Cache,
+    Interface,
     Parse,
+    Parse_Lexer,
+    Import,
     Semantic,
     Semantic_Declarations,
     Semantic_Body,
+    Semantic_RemoveUnused,
     CFG,
     Codegen,
+    Codegen_Link,
+    JIT,
     Compile,
+    Compile_Optimize,
+    Compile_Emit,
+    Compile_Link,
     Run,
     Total,
     size,
 };
 static std::unordered_map<StatType, std::string> StatType_to_str = {
+    {StatType::Cache, "Cache"},
+    {StatType::Interface, "Interface"},
     {StatType::Parse, "Parse"},
+    {StatType::Parse_Lexer, "Lexer"},
+    {StatType::Import, "Import"},
     {StatType::Semantic, "Semantic"},
     {StatType::Semantic_Declarations, "Declarations"},
     {StatType::Semantic_Body, "Body"},
+    {StatType::Semantic_RemoveUnused, "RemoveUnused"},
     {StatType::CFG, "CFG"},
     {StatType::Codegen, "Codegen"},
+    {StatType::Codegen_Link, "Link modules"},
+    {StatType::JIT, "JIT"},
     {StatType::Compile, "Compile"},
+    {StatType::Compile_Optimize, "Optimize"},
+    {StatType::Compile_Emit, "Emit"},
+    {StatType::Compile_Link, "Link"},
     {StatType::Run, "Run"},
     {StatType::Total, "Total"},
 };
+enum class CounterType : int {
+    Tokens,
+    ASTNodes,
+    ResolvedDecls,
+    Specializations,
+    LLVMInstructions,
+    CacheHits,
+    size,
+};
+static std::unordered_map<CounterType, std::string> CounterType_to_str = {
+    {CounterType::Tokens, "tokens"},
+    {CounterType::ASTNodes, "ast_nodes"},
+    {CounterType::ResolvedDecls, "resolved_decls"},
+    {CounterType::Specializations, "specializations"},
+    {CounterType::LLVMInstructions, "llvm_instructions"},
+    {CounterType::CacheHits, "cache_hits"},
+};
+
+// Allocations made through the global operator new (src/Stats.cpp), only counted while the stats are enabled
+struct AllocationCounter {
+    static inline std::atomic<bool> enabled = false;
+    static inline std::atomic<uint64_t> count = 0;
+    static inline std::atomic<uint64_t> bytes = 0;
+};
+
 class Stats {
    public:
     struct Stat {
         StatType type;
         std::vector<Stat> subStats = {};
+        // Timed once per file on the threads that import the modules, the time is their sum and not a wall time
+        bool threadSum = false;
 
         void dump(size_t level, double parentTime) const {
-            auto stats = Stats::instance();
+            auto &stats = Stats::instance();
             double time = stats.get_time(type);
             double percentage = time / parentTime * 100;
-            std::cerr << indent_line(level, 0, true) << std::left << std::setw(20) << StatType_to_str[type];
+            std::cerr << indent_line(level, 0, true) << std::left << std::setw(20)
+                      << StatType_to_str[type] + (threadSum ? " (sum)" : "");
 
             std::cerr << std::fixed << std::setprecision(2) << indent(2) << std::setw(5) << percentage << "%";
             std::cerr << std::fixed << std::setprecision(4) << indent(2) << std::setw(10) << time << "ms";
@@ -52,59 +104,344 @@ class Stats {
             for (auto&& v : subStats) {
                 v.dump(level + 1, time);
             }
+            for (auto&& [name, namedTime] : stats.get_named_times(type)) {
+                std::cerr << indent_line(level + 1, 0, true) << std::left << std::setw(20) << name;
+                std::cerr << std::fixed << std::setprecision(2) << indent(2) << std::setw(5)
+                          << namedTime / time * 100 << "%";
+                std::cerr << std::fixed << std::setprecision(4) << indent(2) << std::setw(10) << namedTime << "ms";
+                std::cerr << "\n";
+            }
         }
     };
 
     std::vector<Stat> stat_map = {
-        Stat{.type = StatType::Parse},
+        Stat{.type = StatType::Cache},
+        Stat{.type = StatType::Interface, .threadSum = true},
+        Stat{.type = StatType::Parse,
+             .subStats =
+                 {
+                     Stat{.type = StatType::Parse_Lexer, .threadSum = true},
+                 },
+             .threadSum = true},
+        Stat{.type = StatType::Import},
         Stat{.type = StatType::Semantic,
              .subStats =
                  {
                      Stat{.type = StatType::Semantic_Declarations},
                      Stat{.type = StatType::Semantic_Body},
+                     Stat{.type = StatType::Semantic_RemoveUnused},
                  }},
         Stat{.type = StatType::CFG},
-        Stat{.type = StatType::Codegen},
-        Stat{.type = StatType::Compile},
+        Stat{.type = StatType::Codegen,
+             .subStats =
+                 {
+                     Stat{.type = StatType::Codegen_Link},
+                 }},
+        Stat{.type = StatType::JIT},
+        Stat{.type = StatType::Compile,
+             .subStats =
+                 {
+                     Stat{.type = StatType::Compile_Optimize},
+                     Stat{.type = StatType::Compile_Emit},
+                     Stat{.type = StatType::Compile_Link},
+                 }},
         Stat{.type = StatType::Run},
     };
     std::array<double, static_cast<size_t>(StatType::size)> stat_array = {};
+    // Times of the parts of a stat that run concurrently (one per module, ...), they are not added to the stat
+    std::array<std::map<std::string, double>, static_cast<size_t>(StatType::size)> named_stat_array = {};
+    // Allocations made while a stat was running, the ones of other threads running at the same time included
+    std::array<uint64_t, static_cast<size_t>(StatType::size)> alloc_count_array = {};
+    std::array<uint64_t, static_cast<size_t>(StatType::size)> alloc_bytes_array = {};
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(CounterType::size)> counter_array = {};
+    std::mutex stat_mutex;
+
+    // Self time of a declaration or generic specialization, keyed by the declaration
+    struct DeclTime {
+        std::string name;
+        const void* generic = nullptr;
+        double sema = 0;
+        double codegen = 0;
+    };
+    struct GenericCount {
+        std::string name;
+        uint64_t instantiations = 0;
+    };
+    std::unordered_map<const void*, DeclTime> decl_time_map;
+    std::unordered_map<const void*, GenericCount> generic_count_map;
+
+    void dump_json_stat(std::ostream& json, const Stat& stat, const std::string& prefix) {
+        std::string name = prefix + StatType_to_str[stat.type];
+        size_t i = static_cast<size_t>(stat.type);
+        std::unique_lock lock(stat_mutex);
+        json << ",\n    \"" << name << "\": {\"ms\": " << std::fixed << std::setprecision(4) << stat_array[i]
+             << ", \"allocations\": " << alloc_count_array[i] << ", \"allocated_bytes\": " << alloc_bytes_array[i]
+             << "}";
+        lock.unlock();
+        for (auto&& v : stat.subStats) {
+            dump_json_stat(json, v, name + ".");
+        }
+    }
+
+    void collect_times(std::vector<std::pair<std::string, double>>& times, const Stat& stat,
+                       const std::string& prefix) {
+        std::string name = prefix + StatType_to_str[stat.type];
+        times.emplace_back(name, get_time(stat.type));
+        for (auto&& v : stat.subStats) {
+            collect_times(times, v, name + ".");
+        }
+    }
 
    public:
+    // The stats are collected when they are printed or written to a file
+    static bool enabled() {
+        auto& driver = Driver::instance_ptr();
+        return driver && (driver->m_options.printStats || !driver->m_options.statsJson.empty() ||
+                          driver->m_options.benchCompiler);
+    }
+
+    // The time of every declaration is collected for -ftime-report-decls
+    static bool decls_enabled() {
+        auto& driver = Driver::instance_ptr();
+        return driver && driver->m_options.timeReportDecls > 0;
+    }
+
+    static long peak_rss_kb() {
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+        return usage.ru_maxrss;
+    }
+
     void dump() {
         for (auto&& v : stat_map) {
             v.dump(0, get_time(StatType::Total));
         }
+        for (size_t i = 0; i < static_cast<size_t>(CounterType::size); i++) {
+            std::cerr << std::left << std::setw(20) << CounterType_to_str[static_cast<CounterType>(i)] << indent(2)
+                      << counter_array[i] << "\n";
+        }
+        std::cerr << std::left << std::setw(20) << "peak_rss" << indent(2) << peak_rss_kb() << "KB\n";
     }
 
-    void add_time(StatType t, double time) { stat_array[static_cast<size_t>(t)] += time; }
+    // Top declarations by self time and top generics by instantiations
+    void dump_decls(size_t top) {
+        std::unique_lock lock(stat_mutex);
+        std::vector<const DeclTime*> decls;
+        for (auto&& [decl, time] : decl_time_map) decls.emplace_back(&time);
+        std::sort(decls.begin(), decls.end(), [](const DeclTime* a, const DeclTime* b) {
+            if (a->sema + a->codegen != b->sema + b->codegen) return a->sema + a->codegen > b->sema + b->codegen;
+            return a->name < b->name;
+        });
 
-    double get_time(StatType t) { return stat_array[static_cast<size_t>(t)]; }
+        std::cerr << "Declarations (top " << std::min(top, decls.size()) << " of " << decls.size() << ", self time)\n";
+        std::cerr << std::left << std::setw(40) << "name" << std::right << std::setw(12) << "sema ms" << std::setw(12)
+                  << "codegen ms" << std::setw(12) << "total ms" << "\n";
+        for (size_t i = 0; i < decls.size() && i < top; i++) {
+            std::cerr << std::left << std::setw(40) << decls[i]->name << std::right << std::fixed
+                      << std::setprecision(4) << std::setw(12) << decls[i]->sema << std::setw(12) << decls[i]->codegen
+                      << std::setw(12) << decls[i]->sema + decls[i]->codegen << "\n";
+        }
+
+        // The time of a generic is the one of its specializations
+        std::vector<std::tuple<std::string, uint64_t, double, double>> generics;
+        for (auto&& [generic, count] : generic_count_map) {
+            double sema = 0, codegen = 0;
+            for (auto&& [decl, time] : decl_time_map) {
+                if (time.generic != generic) continue;
+                sema += time.sema;
+                codegen += time.codegen;
+            }
+            generics.emplace_back(count.name, count.instantiations, sema, codegen);
+        }
+        std::sort(generics.begin(), generics.end(), [](const auto& a, const auto& b) {
+            if (std::get<1>(a) != std::get<1>(b)) return std::get<1>(a) > std::get<1>(b);
+            return std::get<0>(a) < std::get<0>(b);
+        });
+
+        std::cerr << "Generics (top " << std::min(top, generics.size()) << " of " << generics.size() << ")\n";
+        std::cerr << std::left << std::setw(40) << "name" << std::right << std::setw(16) << "instantiations"
+                  << std::setw(12) << "sema ms" << std::setw(12) << "codegen ms" << "\n";
+        for (size_t i = 0; i < generics.size() && i < top; i++) {
+            auto&& [name, instantiations, sema, codegen] = generics[i];
+            std::cerr << std::left << std::setw(40) << name << std::right << std::setw(16) << instantiations
+                      << std::fixed << std::setprecision(4) << std::setw(12) << sema << std::setw(12) << codegen
+                      << "\n";
+        }
+    }
+
+    // Flat object with the times and allocations of the phases, named by their path in the tree, and the counters
+    void dump_json(const std::filesystem::path& path) {
+        std::ofstream json(path);
+        if (!json.is_open()) {
+            std::cerr << "ERROR: Could not open file " << path.string() << " for writing.\n";
+            return;
+        }
+        json << "{\n  \"phases\": {\n    \"Total\": {\"ms\": " << std::fixed << std::setprecision(4)
+             << get_time(StatType::Total) << "}";
+        for (auto&& v : stat_map) {
+            dump_json_stat(json, v, "");
+        }
+        json << "\n  },\n  \"counters\": {";
+        for (size_t i = 0; i < static_cast<size_t>(CounterType::size); i++) {
+            json << (i == 0 ? "" : ",") << "\n    \"" << CounterType_to_str[static_cast<CounterType>(i)]
+                 << "\": " << counter_array[i];
+        }
+        json << "\n  },\n  \"peak_rss_kb\": " << peak_rss_kb() << "\n}\n";
+    }
+
+    // Times of the phases named like in dump_json, the Total first
+    std::vector<std::pair<std::string, double>> phase_times() {
+        std::vector<std::pair<std::string, double>> times = {{"Total", get_time(StatType::Total)}};
+        for (auto&& v : stat_map) {
+            collect_times(times, v, "");
+        }
+        return times;
+    }
+
+    // Used between the compilations of a process that measures each of them
+    void reset() {
+        std::unique_lock lock(stat_mutex);
+        stat_array = {};
+        for (auto&& named : named_stat_array) named.clear();
+        alloc_count_array = {};
+        alloc_bytes_array = {};
+        for (auto&& counter : counter_array) counter = 0;
+        decl_time_map.clear();
+        generic_count_map.clear();
+    }
+
+    void add_time(StatType t, double time) {
+        std::unique_lock lock(stat_mutex);
+        stat_array[static_cast<size_t>(t)] += time;
+    }
+
+    double get_time(StatType t) {
+        std::unique_lock lock(stat_mutex);
+        return stat_array[static_cast<size_t>(t)];
+    }
+
+    void add_named_time(StatType t, const std::string& name, double time) {
+        std::unique_lock lock(stat_mutex);
+        named_stat_array[static_cast<size_t>(t)][name] += time;
+    }
+
+    std::map<std::string, double> get_named_times(StatType t) {
+        std::unique_lock lock(stat_mutex);
+        return named_stat_array[static_cast<size_t>(t)];
+    }
+
+    void add_allocations(StatType t, uint64_t count, uint64_t bytes) {
+        std::unique_lock lock(stat_mutex);
+        alloc_count_array[static_cast<size_t>(t)] += count;
+        alloc_bytes_array[static_cast<size_t>(t)] += bytes;
+    }
+
+    void add_count(CounterType t, uint64_t count = 1) {
+        counter_array[static_cast<size_t>(t)].fetch_add(count, std::memory_order_relaxed);
+    }
+
+    uint64_t get_count(CounterType t) { return counter_array[static_cast<size_t>(t)]; }
+
+    // The name is the last one recorded, codegen runs after the symbol names are resolved
+    void add_decl_time(const void* decl, std::string name, const void* generic, bool codegen, double time) {
+        std::unique_lock lock(stat_mutex);
+        auto& declTime = decl_time_map[decl];
+        declTime.name = std::move(name);
+        if (generic) declTime.generic = generic;
+        (codegen ? declTime.codegen : declTime.sema) += time;
+    }
+
+    void add_instantiation(const void* generic, const std::string& name) {
+        std::unique_lock lock(stat_mutex);
+        auto& count = generic_count_map[generic];
+        count.name = name;
+        count.instantiations++;
+    }
 
     static Stats& instance() {
         static Stats s;
         return s;
     }
 };
-#define __line2_ScopedTimer(type, line)            \
-    ptr<__ScopedTimer> st##line;                   \
-    if (Driver::instance().m_options.printStats) { \
-        st##line = makePtr<__ScopedTimer>(type);   \
+#define __line2_ScopedTimer(type, line)                          \
+    ptr<__ScopedTimer> st##line;                                 \
+    if (::DMZ::Stats::enabled() || ::DMZ::profiler::enabled()) { \
+        st##line = makePtr<__ScopedTimer>(type);                 \
     }
 #define __line1_ScopedTimer(type, line) __line2_ScopedTimer(type, line)
 #define ScopedTimer(type)               __line1_ScopedTimer(type, __LINE__)
 
+// Without a name it behaves like ScopedTimer
+#define __line2_ScopedNamedTimer(type, name, line)               \
+    ptr<__ScopedTimer> st##line;                                 \
+    if (::DMZ::Stats::enabled() || ::DMZ::profiler::enabled()) { \
+        st##line = makePtr<__ScopedTimer>(type, name);           \
+    }
+#define __line1_ScopedNamedTimer(type, name, line) __line2_ScopedNamedTimer(type, name, line)
+#define ScopedNamedTimer(type, name)               __line1_ScopedNamedTimer(type, name, __LINE__)
+
 class __ScopedTimer {
    private:
     std::chrono::time_point<std::chrono::high_resolution_clock> start;
     StatType type;
+    std::string name;
+    // The stats are also the spans of the passes in the -ftime-trace file
+    profiler_timer trace;
+    uint64_t allocCount = AllocationCounter::count;
+    uint64_t allocBytes = AllocationCounter::bytes;
 
    public:
-    __ScopedTimer(StatType t) : type(t) { start = std::chrono::high_resolution_clock::now(); }
+    __ScopedTimer(StatType t, std::string name = "")
+        : type(t), name(std::move(name)), trace(StatType_to_str.at(t).c_str(), this->name) {
+        start = std::chrono::high_resolution_clock::now();
+    }
     ~__ScopedTimer() {
         auto now = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double, std::milli> to_add = now - start;
-        Stats::instance().add_time(type, to_add.count());
+        if (name.empty()) {
+            Stats::instance().add_time(type, to_add.count());
+            Stats::instance().add_allocations(type, AllocationCounter::count - allocCount,
+                                              AllocationCounter::bytes - allocBytes);
+        } else {
+            Stats::instance().add_named_time(type, name, to_add.count());
+        }
+    }
+};
+
+// Time of the resolution or the generation of a declaration, the time of the declarations nested in it (the
+// specializations it instantiates, ...) is not included
+#define __line2_ScopedDeclTimer(decl, name, generic, codegen, line)          \
+    ptr<__ScopedDeclTimer> sdt##line;                                        \
+    if (::DMZ::Stats::decls_enabled()) {                                     \
+        sdt##line = makePtr<__ScopedDeclTimer>(decl, name, generic, codegen); \
+    }
+#define __line1_ScopedDeclTimer(decl, name, generic, codegen, line) \
+    __line2_ScopedDeclTimer(decl, name, generic, codegen, line)
+#define ScopedDeclTimer(decl, name, generic, codegen) __line1_ScopedDeclTimer(decl, name, generic, codegen, __LINE__)
+
+class __ScopedDeclTimer {
+   private:
+    static inline thread_local __ScopedDeclTimer* current = nullptr;
+    std::chrono::time_point<std::chrono::high_resolution_clock> start;
+    const void* decl;
+    std::string name;
+    const void* generic;
+    bool codegen;
+    __ScopedDeclTimer* parent;
+    double nested = 0;
+
+   public:
+    __ScopedDeclTimer(const void* decl, std::string name, const void* generic, bool codegen)
+        : decl(decl), name(std::move(name)), generic(generic), codegen(codegen), parent(current) {
+        current = this;
+        start = std::chrono::high_resolution_clock::now();
+    }
+    ~__ScopedDeclTimer() {
+        auto now = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double, std::milli> elapsed = now - start;
+        current = parent;
+        if (parent) parent->nested += elapsed.count();
+        Stats::instance().add_decl_time(decl, std::move(name), generic, codegen, elapsed.count() - nested);
     }
 };
 }  // namespace DMZ
@@ -2,86 +2,213 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <exception>
 #include <functional>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <vector>
 namespace DMZ {
 
+// Work stealing thread pool.
+// Every worker owns a deque: it pushes and pops its own tasks at the back and the other threads steal from the
+// front. Tasks submitted from outside the pool go to a shared injection queue. A thread waiting for a TaskGroup keeps
+// running queued tasks while it waits, so tasks can submit and wait for nested tasks without deadlocking the pool.
+// With a single thread the tasks are run inline when they are submitted.
 class ThreadPool {
    public:
-#ifdef DMZ_SINGLE_THREADED
-    ThreadPool(size_t num_threads = std::thread::hardware_concurrency()) {}
-
-    void submit(std::function<void()> task) { task(); }
-
-    void wait() {}
-
-    ~ThreadPool() {}
-
-#else
-    ThreadPool(size_t num_threads = std::thread::hardware_concurrency()) : stop(false), active_tasks(0) {
-        for (size_t i = 0; i < num_threads; ++i) {
-            workers.emplace_back([this] {
-                while (true) {
-                    std::function<void()> task;
-                    {
-                        std::unique_lock<std::mutex> lock(this->queue_mutex);
-                        this->condition.wait(lock, [this] { return this->stop || !this->tasks.empty(); });
-
-                        if (this->stop && this->tasks.empty()) {
-                            return;
-                        }
-                        task = std::move(this->tasks.front());
-                        this->tasks.pop();
-                    }
-
-                    task();
-
-                    active_tasks--;
-                    completion_condition.notify_one();
-                }
-            });
+    class TaskGroup {
+       public:
+        explicit TaskGroup(ThreadPool &pool) : m_pool(pool) {}
+        TaskGroup(const TaskGroup &) = delete;
+        TaskGroup &operator=(const TaskGroup &) = delete;
+        ~TaskGroup() { m_pool.help_until(*this); }
+
+        void submit(std::function<void()> task) { m_pool.push(*this, std::move(task)); }
+
+        // Waits for the tasks of this group, including the ones submitted by its tasks, and rethrows the first
+        // exception thrown by any of them
+        void wait() {
+            m_pool.help_until(*this);
+            std::exception_ptr exception;
+            {
+                std::unique_lock<std::mutex> lock(m_exceptionMutex);
+                std::swap(exception, m_exception);
+            }
+            if (exception) std::rethrow_exception(exception);
+        }
+
+       private:
+        friend class ThreadPool;
+        ThreadPool &m_pool;
+        std::atomic<size_t> m_pending = 0;
+        std::mutex m_exceptionMutex;
+        std::exception_ptr m_exception;
+    };
+
+    ThreadPool(int num_threads = 1) { resize(num_threads); }
+
+    // Waits for the submitted tasks and restarts the pool with another number of threads, no other TaskGroup can have
+    // pending tasks
+    void resize(int num_threads) {
+        stop_workers();
+        if (num_threads <= 0) num_threads = std::thread::hardware_concurrency();
+        if (num_threads <= 1) return;
+
+        // One queue per worker plus the injection queue
+        m_numWorkers = num_threads;
+        for (size_t i = 0; i < m_numWorkers + 1; ++i) {
+            m_queues.emplace_back(std::make_unique<WorkQueue>());
+        }
+        for (size_t i = 0; i < m_numWorkers; ++i) {
+            m_workers.emplace_back([this, i] { worker_loop(i); });
         }
     }
 
-    void submit(std::function<void()> task) {
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t size() const { return m_numWorkers == 0 ? 1 : m_numWorkers; }
+
+    void submit(std::function<void()> task) { m_defaultGroup.submit(std::move(task)); }
+
+    void wait() { m_defaultGroup.wait(); }
+
+    ~ThreadPool() { stop_workers(); }
+
+   private:
+    struct Task {
+        std::function<void()> function;
+        TaskGroup *group = nullptr;
+    };
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void stop_workers() {
+        help_until(m_defaultGroup);
         {
-            std::unique_lock<std::mutex> lock(queue_mutex);
-            tasks.push(std::move(task));
-            active_tasks++;
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_condition.notify_all();
+        for (std::thread &worker : m_workers) {
+            worker.join();
         }
-        condition.notify_one();
+        m_workers.clear();
+        m_queues.clear();
+        m_numWorkers = 0;
+        m_stop = false;
     }
 
-    void wait() {
-        std::unique_lock<std::mutex> lock(queue_mutex);
-        completion_condition.wait(lock, [this] { return tasks.empty() && active_tasks == 0; });
-    }
+    size_t current_queue() const { return t_pool == this ? t_index : m_numWorkers; }
+
+    void push(TaskGroup &group, std::function<void()> function) {
+        group.m_pending++;
+        Task task{std::move(function), &group};
+        if (m_numWorkers == 0) {
+            run_task(task);
+            return;
+        }
 
-    ~ThreadPool() {
-        wait();
         {
-            std::unique_lock<std::mutex> lock(queue_mutex);
-            stop = true;
+            WorkQueue &queue = *m_queues[current_queue()];
+            std::unique_lock<std::mutex> lock(queue.mutex);
+            queue.tasks.emplace_back(std::move(task));
         }
-        condition.notify_all();
-        for (std::thread& worker : workers) {
-            worker.join();
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_queued++;
+        }
+        m_condition.notify_all();
+    }
+
+    bool try_pop(size_t self, Task &task) {
+        if (self < m_numWorkers) {
+            WorkQueue &own = *m_queues[self];
+            std::unique_lock<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                m_queued--;
+                return true;
+            }
+        }
+
+        for (size_t i = 1; i <= m_queues.size(); ++i) {
+            size_t victim = (self + i) % m_queues.size();
+            if (victim == self) continue;
+            WorkQueue &queue = *m_queues[victim];
+            std::unique_lock<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                m_queued--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run_task(Task &task) {
+        TaskGroup &group = *task.group;
+        try {
+            task.function();
+        } catch (...) {
+            std::unique_lock<std::mutex> lock(group.m_exceptionMutex);
+            if (!group.m_exception) group.m_exception = std::current_exception();
+        }
+        // The group can be destroyed as soon as its counter reaches zero, do not touch it afterwards
+        if (--group.m_pending == 0) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.notify_all();
+        }
+    }
+
+    void help_until(TaskGroup &group) {
+        size_t self = current_queue();
+        while (group.m_pending > 0) {
+            Task task;
+            if (try_pop(self, task)) {
+                run_task(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [&] { return group.m_pending == 0 || m_queued > 0; });
+        }
+    }
+
+    void worker_loop(size_t index) {
+        t_pool = this;
+        t_index = index;
+        while (true) {
+            Task task;
+            if (try_pop(index, task)) {
+                run_task(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_stop || m_queued > 0; });
+            if (m_stop && m_queued == 0) return;
         }
     }
 
    private:
-    std::vector<std::thread> workers;
-    std::queue<std::function<void()> > tasks;
+    size_t m_numWorkers = 0;
+    std::vector<std::thread> m_workers;
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::atomic<size_t> m_queued = 0;
+    bool m_stop = false;
 
-    std::mutex queue_mutex;
-    std::condition_variable condition;
-    std::condition_variable completion_condition;
+    TaskGroup m_defaultGroup{*this};
 
-    bool stop;
-    std::atomic<int> active_tasks;
-#endif  // DMZ_SINGLE_THREADED
+    static inline thread_local ThreadPool *t_pool = nullptr;
+    static inline thread_local size_t t_index = 0;
 };
-}  // namespace DMZ
\ No newline at end of file
+}  // namespace DMZ
@@ -20,9 +20,47 @@ namespace DMZ {
     throw std::runtime_error(error_msg);
 }
 
+// Names of the source files, every file is identified by a 32 bit id so the locations do not own a copy of its name,
+// the name is only looked up to print a location
+class SourceManager {
+   public:
+    SourceManager(const SourceManager&) = delete;
+    SourceManager& operator=(const SourceManager&) = delete;
+
+    static SourceManager& instance() {
+        static SourceManager s;
+        return s;
+    }
+
+    // The id of a name is the same for the whole process, 0 is the empty name
+    uint32_t file_id(std::string_view name) {
+        std::unique_lock lock(m_mutex);
+        auto it = m_ids.find(name);
+        if (it != m_ids.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(m_names.size());
+        // The names never move in the deque, so the keys are views of them
+        m_ids.emplace(m_names.emplace_back(name), id);
+        return id;
+    }
+
+    const std::string& file_name(uint32_t id) {
+        std::unique_lock lock(m_mutex);
+        return m_names[id];
+    }
+
+   private:
+    SourceManager() { m_ids.emplace(m_names.emplace_back(), 0); }
+
+    std::mutex m_mutex;
+    std::deque<std::string> m_names;
+    std::unordered_map<std::string_view, uint32_t> m_ids;
+};
+
 struct SourceLocation {
-    std::string file_name = {};
-    size_t line = 0, col = 0, len = 1;
+    uint32_t file_id = 0;
+    uint32_t line = 0, col = 0, len = 1;
+
+    const std::string& file_name() const { return SourceManager::instance().file_name(file_id); }
 
     std::string to_string() const {
         std::stringstream os;
@@ -31,7 +69,7 @@ struct SourceLocation {
     }
 
     friend std::ostream& operator<<(std::ostream& os, const SourceLocation& s) {
-        os << s.file_name.data() << ":" << s.line << ":" << s.col + 1;
+        os << s.file_name() << ":" << s.line << ":" << s.col + 1;
         return os;
     }
 };
@@ -78,13 +116,15 @@ struct SourceLocation {
     }
     std::cerr << bold << message << reset << '\n';
 
-    std::string line = get_file_line(loc.file_name, loc.line);
+    std::string line = get_file_line(loc.file_name(), loc.line);
     if (!line.empty()) {
         std::cerr << " " << loc.line << " | ";
         if (is_terminal) {
-            std::string before = line.substr(0, std::min(loc.col, line.size()));
-            std::string error_part = (loc.col < line.size()) ? line.substr(loc.col, std::min(loc.len, line.size() - loc.col)) : "";
-            std::string after = (loc.col + error_part.size() < line.size()) ? line.substr(loc.col + error_part.size()) : "";
+            std::string before = line.substr(0, std::min<size_t>(loc.col, line.size()));
+            std::string error_part =
+                (loc.col < line.size()) ? line.substr(loc.col, std::min<size_t>(loc.len, line.size() - loc.col)) : "";
+            std::string after =
+                (loc.col + error_part.size() < line.size()) ? line.substr(loc.col + error_part.size()) : "";
             std::cerr << before << (isWarning ? yellow : red) << bold << error_part << reset << after << '\n';
         } else {
             std::cerr << line << '\n';
@@ -267,6 +307,15 @@ overload(Ts...) -> overload<Ts...>;
     return {};
 }
 
+// 64 bit FNV-1a, stable between runs so it can be used in on-disk keys
+[[maybe_unused]] static inline uint64_t hash_fnv1a(std::string_view data, uint64_t hash = 14695981039346656037ull) {
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
 template <typename from, typename to>
 std::vector<std::unique_ptr<to>> move_vector_ptr(std::vector<std::unique_ptr<from>>& source_vector) {
     std::vector<std::unique_ptr<to>> target_vector;
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "DMZPCHLLVM.hpp"
+
+namespace DMZ {
+
+class Backend {
+    std::string m_optimizationLevel;
+    ptr<llvm::TargetMachine> m_targetMachine;
+
+   public:
+    Backend(std::string_view optimizationLevel);
+
+    static llvm::OptimizationLevel optimization_level(std::string_view optimizationLevel);
+    static llvm::CodeGenOptLevel codegen_level(std::string_view optimizationLevel);
+    static ptr<llvm::TargetMachine> create_target_machine(std::string_view optimizationLevel);
+    static void optimize_module(llvm::Module &module, llvm::OptimizationLevel level,
+                                llvm::TargetMachine *targetMachine = nullptr);
+
+    bool create();
+    void optimize_module(llvm::Module &module);
+    bool emit_file(llvm::Module &module, llvm::raw_pwrite_stream &out, llvm::CodeGenFileType fileType);
+    bool emit_file(llvm::Module &module, const std::filesystem::path &path, llvm::CodeGenFileType fileType);
+};
+}  // namespace DMZ
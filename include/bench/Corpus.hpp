@@ -0,0 +1,33 @@
+#pragma once
+
+#include "driver/Driver.hpp"
+
+namespace DMZ::bench {
+
+// Median and standard deviation of the time of a phase over the runs, in ms
+struct PhaseSummary {
+    double median = 0;
+    double stddev = 0;
+};
+
+// Compiles every dmz file of a directory several times in-process, up to the object in memory, and reports the median
+// and the deviation of the time of every phase from the stats. The results can be saved as the baseline of a later run,
+// that reports the phases whose median grows more than the threshold and fails when there is any.
+class CorpusBench {
+   public:
+    CorpusBench(CompilerOptions options) : m_options(std::move(options)) {}
+
+    int run();
+
+   private:
+    CompilerOptions m_options;
+    // Phases of every file, relative to the corpus directory, in the order of the stats
+    std::map<std::string, std::vector<std::pair<std::string, PhaseSummary>>> m_results;
+
+    std::vector<std::filesystem::path> corpus_files();
+    std::optional<std::vector<std::pair<std::string, double>>> compile(const std::filesystem::path& source);
+    bool save(const std::filesystem::path& path);
+    std::optional<std::map<std::pair<std::string, std::string>, double>> load_baseline(
+        const std::filesystem::path& path);
+};
+}  // namespace DMZ::bench
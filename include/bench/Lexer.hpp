@@ -0,0 +1,20 @@
+#pragma once
+
+#include "driver/Driver.hpp"
+
+namespace DMZ::bench {
+
+// Lexes a dmz file, or every dmz file of a directory, from memory several times and reports the throughput of the
+// lexer in tokens and bytes per second
+class LexerBench {
+   public:
+    LexerBench(CompilerOptions options) : m_options(std::move(options)) {}
+
+    int run();
+
+   private:
+    CompilerOptions m_options;
+
+    std::vector<std::filesystem::path> source_files();
+};
+}  // namespace DMZ::bench
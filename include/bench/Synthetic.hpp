@@ -0,0 +1,71 @@
+#pragma once
+
+#include "driver/Driver.hpp"
+
+namespace DMZ::bench {
+
+// Size and shape of a generated program
+struct Shape {
+    // Functions of every module
+    size_t functions = 64;
+    // Nested ifs and whiles in the body of every function
+    size_t depth = 2;
+    // Instantiations of the generic function and struct, one per generated type
+    size_t generics = 4;
+    // Modules imported by the main module, every module also imports the previous one
+    size_t imports = 2;
+    // Cases of the switch and branches of the if/else chain in every function
+    size_t chain = 4;
+
+    // Null for an unknown dimension
+    size_t* dimension(std::string_view name);
+};
+
+// Writes the dmz sources of a program of the given shape into a directory
+class SyntheticGenerator {
+   public:
+    SyntheticGenerator(Shape shape) : m_shape(shape) {}
+
+    // Returns the path of the main module
+    std::filesystem::path write(const std::filesystem::path& directory);
+    size_t lines() const { return m_lines; }
+    size_t decls() const { return m_decls; }
+
+   private:
+    Shape m_shape;
+    size_t m_lines = 0;
+    size_t m_decls = 0;
+
+    std::string module_source(size_t module, bool isMain);
+    void function_source(std::ostream& out, size_t function, bool isPublic, std::string_view call);
+};
+
+struct PhaseTimes {
+    double lex = 0;
+    double parse = 0;
+    double sema = 0;
+    double codegen = 0;
+
+    double total() const { return lex + parse + sema + codegen; }
+};
+
+// Runs the front end of the compiler in-process over generated programs, doubling every dimension of the shape in
+// turn, and reports the time of every pass, the throughput and how the time of every pass scales with the input.
+// The shape is read from a list like `functions=64,depth=2,generics=4,imports=2,chain=4,steps=4,runs=3`.
+class SyntheticBench {
+   public:
+    SyntheticBench(CompilerOptions options) : m_options(std::move(options)) {}
+
+    int run();
+
+   private:
+    CompilerOptions m_options;
+    Shape m_shape;
+    size_t m_steps = 4;
+    size_t m_runs = 3;
+
+    bool parse_shape(const std::string& spec);
+    std::optional<PhaseTimes> measure(const std::filesystem::path& source);
+    std::optional<PhaseTimes> compile(const std::filesystem::path& source);
+};
+}  // namespace DMZ::bench
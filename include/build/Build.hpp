@@ -0,0 +1,44 @@
+#pragma once
+
+#include "driver/Driver.hpp"
+
+namespace DMZ::build {
+
+struct Target {
+    enum class Kind { Executable, Module };
+
+    Kind kind;
+    std::string name;
+    std::filesystem::path source;
+    std::filesystem::path output;
+    // The source and every module it imports, directly or not
+    std::vector<std::filesystem::path> inputs;
+    // Module targets imported by this target, they are built first
+    std::vector<size_t> dependencies;
+};
+
+// Builds the targets listed in the dmz.build manifest of a project directory.
+// Every line of the manifest is a target, `exe <name> <source>` or `module <name> <source>`, with the sources relative
+// to the project. The imports of every target are scanned to order the modules before the targets that import them,
+// independent targets are compiled in parallel (-j) by child compilers and a target is skipped when its inputs did not
+// change since its last build. The outputs go to <dir>/build, or to the -o directory.
+class ProjectBuild {
+   public:
+    ProjectBuild(CompilerOptions options);
+
+    int run();
+
+   private:
+    CompilerOptions m_options;
+    std::filesystem::path m_projectDir;
+    std::filesystem::path m_outputDir;
+    std::vector<Target> m_targets;
+
+    bool read_manifest();
+    std::vector<std::filesystem::path> scan_imports(const std::filesystem::path& source);
+    bool resolve_dependencies();
+    std::vector<std::string> target_arguments(const Target& target);
+    std::string input_stamp(const Target& target);
+    std::filesystem::path stamp_path(const Target& target);
+};
+}  // namespace DMZ::build
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "DMZPCHLLVM.hpp"
+
+namespace DMZ {
+
+// On-disk cache of the generated llvm modules.
+// An entry is keyed by the root source, the compiler binary and the options that change the generated code. It
+// records the content hash of every module that took part in the compilation, so editing any transitive import
+// invalidates it, and the objects of the imported modules that the program links.
+// The imported modules are cached on their own, as module objects with their interface (see module_path), so every
+// program that imports them reuses them.
+class Cache {
+    std::filesystem::path m_directory;
+    std::string m_key;
+    // The modules and the objects of the entry read by load
+    std::vector<std::filesystem::path> m_modules;
+    std::vector<std::filesystem::path> m_objects;
+
+   public:
+    Cache(std::filesystem::path directory, const std::filesystem::path &source, std::string_view configuration);
+
+    ptr<llvm::Module> load(llvm::LLVMContext &context);
+    bool store(const std::vector<std::filesystem::path> &modules, const std::vector<std::filesystem::path> &objects,
+               const llvm::Module &module);
+    const std::vector<std::filesystem::path> &modules() const { return m_modules; }
+    const std::vector<std::filesystem::path> &objects() const { return m_objects; }
+
+    // Path of the cached build of an imported module, keyed by the module path, the compiler binary and the options
+    // that change its object. Its interface and object are named after it.
+    static std::filesystem::path module_path(const std::filesystem::path &directory,
+                                             const std::filesystem::path &module, std::string_view configuration);
+
+    static std::optional<uint64_t> hash_file(const std::filesystem::path &path);
+    static uint64_t compiler_hash();
+
+   private:
+    std::filesystem::path entry_path() const { return m_directory / (m_key + ".dmzc"); }
+};
+}  // namespace DMZ
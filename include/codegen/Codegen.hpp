@@ -7,7 +7,15 @@
 namespace DMZ {
 
 class Codegen {
-    std::vector<ptr<ResolvedDecl>> m_resolvedTree;
+    std::vector<ptr<ResolvedDecl>> m_ownedTree;
+    const std::vector<ptr<ResolvedDecl>> &m_resolvedTree;
+    // When set only the function bodies and globals of this top level module are emitted, everything else is declared
+    const ResolvedModuleDecl *m_ownedModule = nullptr;
+    bool m_emitBodies = true;
+    // Modules whose object is being built, the functions they do not own can also be emitted by their importers
+    std::unordered_set<const ResolvedModuleDecl *> m_exportedModules;
+    // The program links the objects of modules read from their interface
+    bool m_linksInterfaces = false;
 
     ptr<llvm::LLVMContext> m_context;
     llvm::IRBuilder<> m_builder;
@@ -61,8 +69,11 @@ class Codegen {
 
    public:
     Codegen(std::vector<ptr<ResolvedModuleDecl>> resolvedTree, std::string_view sourcePath, bool debugSymbols);
+    Codegen(const std::vector<ptr<ResolvedDecl>> &resolvedTree, const ResolvedModuleDecl &ownedModule,
+            std::string_view sourcePath, bool debugSymbols);
 
-    std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>> generate_ir(bool runTest);
+    void export_module(const ResolvedModuleDecl &moduleDecl) { m_exportedModules.emplace(&moduleDecl); }
+    std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>> generate_ir(bool runTest, bool runBench);
     llvm::Type *generate_type(const ResolvedType &type, bool noOpaque = false);
     llvm::DIType *generate_debug_type(const ResolvedType &type);
     llvm::DIFile *generate_debug_file(const SourceLocation &location);
@@ -82,7 +93,7 @@ class Codegen {
     llvm::Value *generate_expr(const ResolvedExpr &expr, bool keepPointer = false);
     llvm::Value *generate_call_expr(const ResolvedCallExpr &call);
     llvm::Value *generate_lambda_expr(const ResolvedLambdaExpr &expr);
-    void generate_main_wrapper(bool runTest);
+    void generate_main_wrapper(bool runTest, bool runBench);
     llvm::AttributeList construct_attr_list(const ResolvedTypeFunction &fnType);
     llvm::Value *generate_unary_operator(const ResolvedUnaryOperator &unop);
     llvm::Value *generate_ref_ptr_expr(const ResolvedRefPtrExpr &expr);
@@ -115,6 +126,8 @@ class Codegen {
     void generate_union_fields(const ResolvedUnionDecl &unionDecl);
     void generate_union_functions(const ResolvedUnionDecl &unionDecl);
     void break_into_bb(llvm::BasicBlock *targetBB);
+    llvm::GlobalValue::LinkageTypes error_linkage() const;
+    llvm::GlobalValue::LinkageTypes function_linkage(const ResolvedFuncDecl &functionDecl) const;
     void generate_error_no_err();
     void generate_error_group_expr_decl(const ResolvedErrorGroupExprDecl &ErrorGroupExprDecl);
     llvm::Value *generate_error_in_place_expr(const ResolvedErrorInPlaceExpr &errorInPlaceExpr);
@@ -123,6 +136,7 @@ class Codegen {
     llvm::Value *generate_orelse_error_expr(const ResolvedOrElseErrorExpr &orelseErrorExpr, bool keepPointer);
     void generate_module_decl(const ResolvedModuleDecl &moduleDecl);
     void generate_module_body(const ResolvedModuleDecl &moduleDecl);
+    bool is_owned_module(const ResolvedModuleDecl &moduleDecl) const;
     void generate_in_module_decl(const std::vector<ptr<ResolvedDecl>> &declarations);
     void generate_in_module_body(const std::vector<ptr<ResolvedDecl>> &declarations);
     llvm::Value *generate_switch_stmt(const ResolvedSwitchStmt &stmt);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "DMZPCH.hpp"
+#include "cache/Cache.hpp"
 #include "codegen/Codegen.hpp"
 #include "lexer/Lexer.hpp"
 #include "linker/Linker.hpp"
@@ -24,6 +25,7 @@ struct CompilerOptions {
     bool depsDump = false;
     bool depsDotDump = false;
     bool llvmDump = false;
+    bool emitLLVMBC = false;
     bool asmDump = false;
     bool cfgDump = false;
     bool fmtDump = false;
@@ -32,11 +34,33 @@ struct CompilerOptions {
     bool fmt = false;
     bool test = false;
     bool testCompiler = false;
+    std::string testFilter;
+    bool bench = false;
     bool isModule = false;
     bool printStats = false;
+    std::filesystem::path statsJson;
+    std::filesystem::path timeTrace;
+    size_t timeReportDecls = 0;
     bool quiet = false;
+    bool force = false;
     bool lsp = false;
     int parallelJobs = 1;
+    bool cache = false;
+    bool buildStd = false;
+    bool build = false;
+    bool benchSynthetic = false;
+    std::string benchShape;
+    bool benchCompiler = false;
+    bool benchLexer = false;
+    int benchRuns = 5;
+    std::filesystem::path benchBaseline;
+    std::filesystem::path benchSave;
+    double benchThreshold = 10;
+    std::filesystem::path cacheDir = ".dmz-cache";
+    bool serve = false;
+    bool client = false;
+    std::filesystem::path socketPath;
+    std::vector<std::string> arguments;
 
     static CompilerOptions parse_arguments(int argc, char** argv);
 };
@@ -47,20 +71,34 @@ class Driver {
     std::vector<ptr<llvm::Module>> modules;
     std::atomic_bool m_haveError = {false};
     std::atomic_bool m_haveNormalExit = {false};
+    std::mutex m_importsMutex;
+    std::atomic_bool m_importing = {false};
+    std::vector<std::filesystem::path> m_failedImports;
+    // Path and symbol name of the modules whose object is being built, written to their interfaces
+    std::vector<std::pair<std::filesystem::path, std::string>> m_exportedModules;
+    // Objects of the imported modules linked by a program loaded from the cache
+    std::vector<std::filesystem::path> m_cachedObjects;
 
    public:
     std::unordered_map<std::filesystem::path, ptr<ModuleDecl>> imported_modules;
+    // Modules registered while parsing each source, used to drop the modules a program does not reach
+    std::unordered_map<std::filesystem::path, std::unordered_set<std::filesystem::path>> module_imports;
+    bool pruneImports = false;
+    // Tokens of the sources lexed before the compilation, by -bench-synthetic, that are parsed without lexing them again
+    std::unordered_map<std::filesystem::path, std::pair<std::vector<Token>, ptr<SourceBuffer>>> lexed_sources;
 
    public:
     CompilerOptions m_options;
-    Driver(CompilerOptions options) : m_options(options) {}
+    Driver(CompilerOptions options) : m_workers(options.parallelJobs), m_options(options) {}
     int main();
     void display_help();
+    void reset(CompilerOptions options);
 
     bool need_exit();
     int exit_code();
 
     void check_sources_pass(std::filesystem::path& source);
+    ptr<Lexer> source_lexer(const std::filesystem::path& source);
     ptr<Lexer> lexer_pass(std::filesystem::path& source);
     ptr<ModuleDecl> parser_pass(ptr<Lexer> lexers);
 
@@ -69,13 +107,38 @@ class Driver {
     static std::pair<std::string, std::filesystem::path> register_import(SourceLocation location,
                                                                          const std::filesystem::path& source,
                                                                          std::string_view imported);
+    void schedule_import(const std::filesystem::path& module_path);
+    void parse_import(const std::filesystem::path& module_path);
+    void prune_imports();
+    std::vector<std::filesystem::path> transitive_imports(const std::filesystem::path& source);
+    std::vector<std::filesystem::path> interface_objects();
+    std::filesystem::path interface_path(const std::filesystem::path& module_path);
+    void build_std_pass();
 
     std::vector<ptr<ResolvedModuleDecl>> semantic_pass(ptr<ModuleDecl> ast);
+    bool is_exported(const ResolvedModuleDecl& moduleDecl);
     std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>> codegen_pass(
         std::vector<ptr<ResolvedModuleDecl>> resolvedTrees);
+    std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>> module_codegen_pass(
+        std::vector<ptr<ResolvedModuleDecl>> resolvedTree);
     int asm_pass(ptr<llvm::Module>& module);
-    int jit_pass(ptr<llvm::Module>& module);
+    int jit_pass(std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>>& module);
+    int lli_pass(ptr<llvm::Module>& module);
+    int pipe_module_pass(const std::vector<const char*>& args, ptr<llvm::Module>& module);
+    int bitcode_pass(ptr<llvm::Module>& module);
     int generate_exec_pass(ptr<llvm::Module>& module);
+    int link_pass(const std::filesystem::path& object);
+    int clang_pass(ptr<llvm::Module>& module, bool assembly);
+    int output_pass(std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>>& module);
+    int interface_pass(const std::vector<std::filesystem::path>& cachedModules);
+
+    bool cacheable();
+    std::string module_configuration();
+    std::string cache_configuration();
+    std::filesystem::path module_cache_path(const std::filesystem::path& module_path);
+    void module_cache_pass(const std::vector<std::filesystem::path>& modules);
+    std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>> cache_load_pass(Cache& cache);
+    void cache_store_pass(Cache& cache, const llvm::Module& module);
 
     int ptrBitSize();
     int typeBitSize(const ResolvedType& type);
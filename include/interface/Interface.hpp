@@ -0,0 +1,32 @@
+#pragma once
+
+#include "lexer/Lexer.hpp"
+
+namespace DMZ {
+
+// Binary interface of a module built with -module, written next to its source (or in the cache for the standard
+// library).
+// It holds the token stream of the module without comments, tests and the bodies of the non generic functions, which
+// are defined in the module object. The importers parse it instead of the source, so they get the declarations,
+// struct layouts, error groups and generic definitions (with their bodies, to specialize them) without lexing and
+// resolving the function bodies again.
+struct ModuleInterface {
+    std::filesystem::path object;
+    std::string symbolName;
+    std::vector<Token> tokens;
+    // The strings of the tokens, one after the other
+    ptr<SourceBuffer> buffer;
+
+    static std::filesystem::path path_for(const std::filesystem::path &source) {
+        return std::filesystem::path(source).replace_extension(".dmzi");
+    }
+
+    // The imports are every module that the source imports, directly or not, whose declarations are in the object
+    static bool write(const std::filesystem::path &source, const std::filesystem::path &path,
+                      const std::filesystem::path &object, std::string_view symbolName,
+                      const std::vector<std::filesystem::path> &imports);
+    // Nothing when there is no interface for the source in path or it is stale: the compiler, the source, any of its
+    // imports or the object changed
+    static std::optional<ModuleInterface> read(const std::filesystem::path &source, const std::filesystem::path &path);
+};
+}  // namespace DMZ
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "DMZPCHLLVM.hpp"
+
+namespace DMZ {
+
+class JIT {
+    std::string m_optimizationLevel;
+    ptr<llvm::orc::LLJIT> m_jit;
+
+   public:
+    JIT(std::string_view optimizationLevel);
+
+    bool create();
+    int run(ptr<llvm::LLVMContext> context, ptr<llvm::Module> module,
+            const std::vector<std::filesystem::path> &objects = {});
+};
+}  // namespace DMZ
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "DMZPCH.hpp"
+#include "lexer/SourceBuffer.hpp"
 
 namespace DMZ {
 
@@ -86,6 +87,7 @@ enum class TokenType {
     kw_switch,
     kw_case,
     kw_test,
+    kw_bench,
     kw_inline,
     kw_break,
     kw_continue,
@@ -131,7 +133,8 @@ std::ostream& operator<<(std::ostream& os, const TokenType& t);
     dmz_unreachable("unexpected operator " + std::to_string(static_cast<int>(op)));
 }
 
-const static std::unordered_map<std::string, TokenType> keywords = {
+// Looked up with a perfect hash in the lexer, the iN and uN types are not listed
+constexpr std::pair<std::string_view, TokenType> keywords[] = {
     {"fn", TokenType::kw_fn},
     {"if", TokenType::kw_if},
     {"else", TokenType::kw_else},
@@ -154,6 +157,7 @@ const static std::unordered_map<std::string, TokenType> keywords = {
     {"switch", TokenType::kw_switch},
     {"case", TokenType::kw_case},
     {"test", TokenType::kw_test},
+    {"bench", TokenType::kw_bench},
     {"inline", TokenType::kw_inline},
     {"break", TokenType::kw_break},
     {"continue", TokenType::kw_continue},
@@ -182,7 +186,8 @@ const static std::unordered_map<std::string, TokenType> keywords = {
 
 struct Token {
     TokenType type = TokenType::invalid;
-    std::string str = {};
+    // View of the source buffer of the lexer, valid while the lexer lives
+    std::string_view str = {};
     SourceLocation loc = {};
 };
 
@@ -193,23 +198,39 @@ class Lexer {
    public:
     Lexer(std::string file_path);
     Lexer(std::string file_path, std::string content);
+    // Replays tokens lexed before, from a module interface or from the source, their strings are views of the buffer
+    Lexer(std::string file_path, std::vector<Token> tokens, ptr<SourceBuffer> buffer, bool isInterface);
     std::vector<Token> tokenize_file();
+    // Lexes the whole source at once and replays it, so the stats time the lexer once per file
+    void tokenize();
     bool next_line();
     Token next_token();
     std::string get_file_name() { return std::filesystem::path(m_source_name).filename().string(); }
 
     std::filesystem::path get_file_path() { return std::filesystem::path(m_source_name); }
+    // Gives away the buffer, read at the first token, so the tokens outlive the lexer
+    ptr<SourceBuffer> take_buffer() { return std::move(m_buffer); }
+    bool is_interface() const { return m_is_interface; }
 
    private:
     bool advance(int num = 1);
+    Token read_token();
+    uint32_t col() const { return static_cast<uint32_t>(m_cur - m_line_begin); }
 
    private:
     std::string m_source_name = {};
-    std::unique_ptr<std::istream> m_input_stream_file = nullptr;
-    std::istream* m_input_stream = nullptr;
-    std::string m_line_buffer = "";
-    bool m_is_cin_stream = false;
-    size_t m_line = 0;
-    size_t m_col = 0;
+    uint32_t m_file_id = 0;
+    // The whole source, read at the first token, the tokens are views of it
+    ptr<SourceBuffer> m_buffer = nullptr;
+    // Next character, current line (without the '\n') and start of the next line in the buffer
+    const char* m_cur = nullptr;
+    const char* m_line_begin = nullptr;
+    const char* m_line_end = nullptr;
+    const char* m_next_line = nullptr;
+    uint32_t m_line = 0;
+    bool m_replay = false;
+    bool m_is_interface = false;
+    std::vector<Token> m_tokens = {};
+    size_t m_next_token = 0;
 };
 }  // namespace DMZ
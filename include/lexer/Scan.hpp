@@ -0,0 +1,14 @@
+#pragma once
+
+#include "DMZPCH.hpp"
+
+namespace DMZ {
+
+// Skip the runs of characters of the lexer 16 or 32 at a time, with SSE2 or AVX2 as the cpu supports, chosen at startup,
+// and one at a time otherwise. They return the first character of [begin, end) out of the run, or end.
+const char* scan_spaces(const char* begin, const char* end);
+const char* scan_identifier(const char* begin, const char* end);
+
+// Instruction set of the scans: "avx2", "sse2" or "scalar"
+std::string_view scan_isa();
+}  // namespace DMZ
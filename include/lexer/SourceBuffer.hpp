@@ -0,0 +1,32 @@
+#pragma once
+
+#include "DMZPCH.hpp"
+
+namespace DMZ {
+
+// Whole contents of a source, the tokens are views of it. A large regular file is mapped in memory so it is read
+// without copies, truncating it while the buffer lives makes the reads past the new end fault with SIGBUS. The
+// sources below 1 MiB, nearly all of them, are read into the buffer.
+class SourceBuffer {
+   public:
+    SourceBuffer(std::string content);
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+    ~SourceBuffer();
+
+    // Null when the file cannot be read, "-" reads the standard input
+    static ptr<SourceBuffer> open(const std::string& path);
+
+    std::string_view data() const { return m_data; }
+    const char* begin() const { return m_data.data(); }
+    const char* end() const { return m_data.data() + m_data.size(); }
+
+   private:
+    SourceBuffer() = default;
+
+    std::string m_content = {};
+    void* m_mapping = nullptr;
+    size_t m_mapping_size = 0;
+    std::string_view m_data = {};
+};
+}  // namespace DMZ
@@ -5,11 +5,27 @@
 namespace DMZ {
 
 class Linker {
-    std::vector<ptr<llvm::orc::ThreadSafeModule>> m_modules;
+    std::vector<std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>>> m_modules;
+    // Modules already written as bitcode (by write_bitcode), linked after the others, by identifier
+    std::vector<std::pair<std::string, std::string>> m_bitcodes;
+    unsigned m_flags;
 
    public:
-    Linker(std::vector<ptr<llvm::orc::ThreadSafeModule>> modules);
+    Linker(std::vector<std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>>> modules,
+           unsigned flags = llvm::Linker::Flags::LinkOnlyNeeded);
+    Linker(std::vector<std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>>> modules,
+           std::vector<std::pair<std::string, std::string>> bitcodes, unsigned flags);
 
-    ptr<llvm::orc::ThreadSafeModule> link_modules();
+    std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>> link_modules();
+
+    // A module is moved to another context through bitcode. Writing it only needs its own context, so the modules
+    // generated on several threads are written there.
+    static std::string write_bitcode(llvm::Module &module);
+    // Drops the declarations without uses, every module generated on its own declares the whole program
+    static void remove_unused_declarations(llvm::Module &module);
+
+   private:
+    bool link_bitcode(llvm::Linker &linker, llvm::LLVMContext &context, const std::string &identifier,
+                      const std::string &bitcode);
 };
-}  // namespace DMZ
\ No newline at end of file
+}  // namespace DMZ
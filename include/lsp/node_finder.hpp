@@ -18,7 +18,7 @@ class NodeFinder {
    private:
     void find_in_type(const ResolvedType& type);
     bool is_at_location(const SourceLocation& loc, size_t length = 0) const;
-    std::string m_target_file;
+    uint32_t m_target_file;
     size_t m_line, m_col;
 };
 
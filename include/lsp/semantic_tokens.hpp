@@ -65,7 +65,7 @@ class SemanticTokensCollector {
     void add_token(const SourceLocation& loc, std::string_view identifier, SemanticTokenType type,
                    uint32_t modifiers = (uint32_t)SemanticTokenModifier::None);
 
-    std::string m_target_file;
+    uint32_t m_target_file;
     std::string m_source;
     std::vector<SemanticToken> m_tokens;
 };
@@ -103,7 +103,7 @@ class Parser {
     std::pair<ptr<ModuleDecl>, bool> parse_source_file();
 
    public:
-    explicit Parser(Lexer &lexer) : m_lexer(lexer) { eat_next_token(); }
+    explicit Parser(Lexer &lexer) : m_lexer(lexer) {}
 
    private:
     bool nextToken_is_generic();
@@ -157,6 +157,7 @@ class Parser {
     ptr<Comment> parse_comment();
     ptr<EmptyLine> parse_empty_line();
     ptr<TestDecl> parse_test_decl();
+    ptr<BenchDecl> parse_bench_decl();
     ptr<SizeofExpr> parse_sizeof_expr();
     ptr<TypeidExpr> parse_typeid_expr();
     ptr<TypeinfoExpr> parse_typeinfo_expr();
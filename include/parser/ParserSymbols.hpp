@@ -19,13 +19,18 @@ class ConstantValueContainer {
     std::optional<Ty> get_constant_value() const { return value; }
 };
 
+// Nodes created in this thread, the parser adds them to the stats
+inline thread_local uint64_t t_astNodes = 0;
+
 struct Decl {
     SourceLocation location;
     bool isPublic;
     std::string identifier;
 
     Decl(SourceLocation location, bool isPublic, std::string_view identifier)
-        : location(location), isPublic(isPublic), identifier(std::move(identifier)) {}
+        : location(location), isPublic(isPublic), identifier(std::move(identifier)) {
+        t_astNodes++;
+    }
     virtual ~Decl() = default;
 
     virtual void dump(size_t level = 0) const = 0;
@@ -41,7 +46,7 @@ struct GenericTypeDecl : public Decl {
 
 struct Stmt {
     SourceLocation location;
-    Stmt(SourceLocation location) : location(location) {}
+    Stmt(SourceLocation location) : location(location) { t_astNodes++; }
 
     virtual ~Stmt() = default;
 
@@ -795,6 +800,9 @@ struct OrElseErrorExpr : public Expr {
 struct ModuleDecl : public Decl {
     std::filesystem::path module_path;
     std::vector<ptr<Decl>> declarations;
+    // Set when the module was read from its interface, the functions without body are defined in this object
+    std::filesystem::path interfaceObject;
+    std::string interfaceSymbol;
 
     ModuleDecl(SourceLocation location, std::string_view identifier, std::filesystem::path module_path,
                std::vector<ptr<Decl>> declarations)
@@ -831,6 +839,16 @@ struct TestDecl : public FunctionDecl {
     std::string to_str() const override;
 };
 
+struct BenchDecl : public FunctionDecl {
+    BenchDecl(SourceLocation location, std::string_view identifier, ptr<Block> body)
+        : FunctionDecl(location, true, identifier,
+                       makePtr<UnaryOperator>(location, makePtr<TypeVoid>(location), TokenType::op_excla_mark), {},
+                       std::move(body)) {}
+
+    void dump(size_t level = 0) const override;
+    std::string to_str() const override;
+};
+
 struct LambdaExpr : public Expr {
     std::vector<ptr<Expr>> captures;
     std::vector<ptr<ParamDecl>> params;
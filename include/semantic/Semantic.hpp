@@ -42,9 +42,12 @@ class Sema {
     ptr<ScopeRAII> m_globalScope;
     ResolvedModuleDecl *m_currentModule = nullptr;
 
-    std::vector<ResolvedTestDecl *> m_tests;
+    std::vector<ResolvedFunctionDecl *> m_tests;
+    std::vector<ResolvedFunctionDecl *> m_benches;
 
     std::vector<ResolvedDecl *> m_pending_decls;
+    // Declarations of a module build that remove_unused keeps, the importers link them from the object
+    std::unordered_set<const ResolvedDecl *> m_exportedDecls;
 
     static std::unordered_map<std::string, ptr<ResolvedDecl>> m_vectorBuiltins;
 
@@ -55,9 +58,10 @@ class Sema {
     bool resolve_ast_body(std::vector<ptr<ResolvedModuleDecl>> &moduleDecls);
     void fill_depends(std::vector<ptr<ResolvedModuleDecl>> &decls);
     void fill_depends(ResolvedDependencies *parent, std::vector<ptr<ResolvedDecl>> &decls);
-    void remove_unused(std::vector<ptr<ResolvedModuleDecl>> &decls, bool buildTest);
-    void remove_unused(std::vector<ptr<ResolvedDecl>> &decls, bool buildTest);
-    bool recurse_needed(ResolvedDependencies &deps, bool buildTest,
+    void export_module(const ResolvedModuleDecl &moduleDecl);
+    void remove_unused(std::vector<ptr<ResolvedModuleDecl>> &decls, bool buildTest, bool buildBench);
+    void remove_unused(std::vector<ptr<ResolvedDecl>> &decls, bool buildTest, bool buildBench);
+    bool recurse_needed(ResolvedDependencies &deps, bool buildTest, bool buildBench,
                         std::unordered_set<ResolvedDependencies *> &recurse_check);
 
    private:
@@ -167,9 +171,9 @@ class Sema {
     bool resolve_func_body(ResolvedFunctionDecl &function, const Block &body);
     void resolve_symbol_names(const std::vector<ptr<ResolvedModuleDecl>> &declarations);
     bool resolve_builtin_function(const ResolvedFunctionDecl &fnDecl);
-    void resolve_builtin_test_num(const ResolvedFunctionDecl &fnDecl);
-    void resolve_builtin_test_name(const ResolvedFunctionDecl &fnDecl);
-    void resolve_builtin_test_run(const ResolvedFunctionDecl &fnDecl);
+    void resolve_builtin_num(const ResolvedFunctionDecl &fnDecl, const std::vector<ResolvedFunctionDecl *> &decls);
+    void resolve_builtin_name(const ResolvedFunctionDecl &fnDecl, const std::vector<ResolvedFunctionDecl *> &decls);
+    void resolve_builtin_run(const ResolvedFunctionDecl &fnDecl, const std::vector<ResolvedFunctionDecl *> &decls);
     void add_dependency(ResolvedDecl *decl);
     ptr<ResolvedSizeofExpr> resolve_sizeof_expr(const SizeofExpr &sizeofExpr);
     ptr<ResolvedTypeidExpr> resolve_typeid_expr(const TypeidExpr &typeidExpr);
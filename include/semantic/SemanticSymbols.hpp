@@ -34,6 +34,9 @@ struct ResolvedExpr : public ConstantValueContainer<int>, public ResolvedStmt {
     void dump_constant_value(size_t level) const;
 };
 
+// Declarations resolved in this thread, the driver adds them to the stats
+inline thread_local uint64_t t_resolvedDecls = 0;
+
 struct ResolvedDecl : public ConstantValueContainer<int> {
     SourceLocation location;
     std::string identifier;
@@ -48,7 +51,9 @@ struct ResolvedDecl : public ConstantValueContainer<int> {
           identifier(std::move(identifier)),
           type(std::move(type)),
           isMutable(isMutable),
-          isPublic(isPublic) {}
+          isPublic(isPublic) {
+        t_resolvedDecls++;
+    }
     virtual ~ResolvedDecl() = default;
 
     virtual void dump(size_t level = 0, bool onlySelf = false) const = 0;
@@ -937,6 +942,7 @@ struct ResolvedModuleDecl : public ResolvedDependencies {
     const ModuleDecl &moduleDecl;
     std::filesystem::path module_path;
     std::vector<ptr<ResolvedDecl>> declarations;
+    std::filesystem::path interfaceObject;
     int tuple_counter = 0;
 
     ResolvedModuleDecl(SourceLocation location, std::string_view identifier, const ModuleDecl &moduleDecl,
@@ -970,4 +976,16 @@ struct ResolvedTestDecl : public ResolvedFunctionDecl {
 
     void dump(size_t level = 0, bool onlySelf = false) const override;
 };
+
+struct ResolvedBenchDecl : public ResolvedFunctionDecl {
+    ResolvedBenchDecl(SourceLocation location, std::string_view identifier, const FunctionDecl *functionDecl,
+                      ptr<ResolvedBlock> body)
+        : ResolvedFunctionDecl(location, true, identifier,
+                               makePtr<ResolvedTypeFunction>(
+                                   location, this, std::vector<ptr<ResolvedType>>{},
+                                   makePtr<ResolvedTypeOptional>(location, makePtr<ResolvedTypeVoid>(location))),
+                               {}, functionDecl, std::move(body)) {}
+
+    void dump(size_t level = 0, bool onlySelf = false) const override;
+};
 }  // namespace DMZ
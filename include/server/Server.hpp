@@ -0,0 +1,37 @@
+#pragma once
+
+#include "driver/Driver.hpp"
+
+namespace DMZ::server {
+
+std::filesystem::path socket_path(const CompilerOptions& options);
+
+// Sends the arguments, working directory and standard streams of this process to the compile server and returns the
+// exit code of the compilation, or nothing when there is no server listening
+std::optional<int> run_client(const CompilerOptions& options);
+
+// Compile server listening on a Unix socket.
+// The modules parsed for a request stay in the driver, so the next requests only parse the sources that changed. Every
+// request is compiled in a forked process with the client streams, the server itself only keeps the parsed modules.
+class CompileServer {
+   public:
+    CompileServer(CompilerOptions options);
+
+    int run();
+
+   private:
+    CompilerOptions m_options;
+    int m_socket = -1;
+
+    // The identifiers in the parsed modules depend on the import paths, the project and the working directories
+    std::unordered_map<std::string, std::filesystem::path> m_imports;
+    std::filesystem::path m_projectDir;
+    std::filesystem::path m_workingDir;
+    std::unordered_map<std::filesystem::path, std::filesystem::file_time_type> m_stamps;
+
+    void handle_request(int connection);
+    int compile(const std::vector<std::string>& arguments, int readyFd);
+    void invalidate_imports(const CompilerOptions& options, const std::filesystem::path& workingDir);
+    void warm_up(const CompilerOptions& options, const std::filesystem::path& workingDir);
+};
+}  // namespace DMZ::server
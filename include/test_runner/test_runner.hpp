@@ -1,4 +1,6 @@
 #pragma once
+#include <filesystem>
+#include <string>
 #include <string_view>
 
 namespace DMZ {
@@ -7,6 +9,12 @@ struct TestOptions {
     int parallel_jobs = 1;
     bool quiet = false;
     std::string binary_path;
+    // Results and durations of the previous runs, the tests that passed with the same inputs are skipped
+    std::filesystem::path cache_file;
+    // Run the tests that passed even when they are in the cache
+    bool force = false;
+    // Run only the test files whose path contains it
+    std::string filter;
 };
 
 int run_tests(std::string_view test_path, const TestOptions& options = {});
@@ -0,0 +1,44 @@
+#include "Stats.hpp"
+
+#include <cstdlib>
+#include <new>
+
+// Replacement of the global allocation functions to count the allocations of every phase in the stats, the count is
+// skipped with a single relaxed load while the stats are disabled
+
+static void *counted_alloc(std::size_t size) {
+    if (DMZ::AllocationCounter::enabled.load(std::memory_order_relaxed)) {
+        DMZ::AllocationCounter::count.fetch_add(1, std::memory_order_relaxed);
+        DMZ::AllocationCounter::bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    if (size == 0) size = 1;
+    while (true) {
+        if (void *ptr = std::malloc(size)) return ptr;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void *operator new(std::size_t size) { return counted_alloc(size); }
+void *operator new[](std::size_t size) { return counted_alloc(size); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return counted_alloc(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return counted_alloc(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
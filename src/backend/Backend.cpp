@@ -0,0 +1,110 @@
+#include "backend/Backend.hpp"
+
+#include "Debug.hpp"
+#include "Stats.hpp"
+
+namespace DMZ {
+Backend::Backend(std::string_view optimizationLevel) : m_optimizationLevel(optimizationLevel) {}
+
+llvm::OptimizationLevel Backend::optimization_level(std::string_view optimizationLevel) {
+    if (optimizationLevel == "-O1") return llvm::OptimizationLevel::O1;
+    if (optimizationLevel == "-O2") return llvm::OptimizationLevel::O2;
+    if (optimizationLevel == "-O3") return llvm::OptimizationLevel::O3;
+    return llvm::OptimizationLevel::O0;
+}
+
+llvm::CodeGenOptLevel Backend::codegen_level(std::string_view optimizationLevel) {
+    if (optimizationLevel == "-O1") return llvm::CodeGenOptLevel::Less;
+    if (optimizationLevel == "-O2") return llvm::CodeGenOptLevel::Default;
+    if (optimizationLevel == "-O3") return llvm::CodeGenOptLevel::Aggressive;
+    return llvm::CodeGenOptLevel::None;
+}
+
+ptr<llvm::TargetMachine> Backend::create_target_machine(std::string_view optimizationLevel) {
+    debug_func("");
+    llvm::InitializeAllTargetInfos();
+    llvm::InitializeAllTargets();
+    llvm::InitializeAllTargetMCs();
+    llvm::InitializeAllAsmPrinters();
+
+    std::string TripleStr = llvm::sys::getDefaultTargetTriple();
+    std::string Error;
+    const llvm::Target *Target = llvm::TargetRegistry::lookupTarget(TripleStr, Error);
+    if (!Target) {
+        debug_msg("cannot find target '" << TripleStr << "': " << Error);
+        return nullptr;
+    }
+
+    llvm::TargetOptions opt;
+    auto RM = std::optional<llvm::Reloc::Model>(llvm::Reloc::PIC_);
+    std::string CPU = llvm::sys::getHostCPUName().str();
+    std::string Features;
+    auto allFeatures = llvm::sys::getHostCPUFeatures();
+    for (auto &feature : allFeatures) {
+        if (feature.second) {
+            Features += "+" + feature.first().str() + ",";
+        }
+    }
+    return ptr<llvm::TargetMachine>(
+        Target->createTargetMachine(TripleStr, CPU, Features, opt, RM, std::nullopt, codegen_level(optimizationLevel)));
+}
+
+void Backend::optimize_module(llvm::Module &module, llvm::OptimizationLevel level,
+                              llvm::TargetMachine *targetMachine) {
+    debug_func("");
+    llvm::LoopAnalysisManager LAM;
+    llvm::FunctionAnalysisManager FAM;
+    llvm::CGSCCAnalysisManager CGAM;
+    llvm::ModuleAnalysisManager MAM;
+
+    llvm::PassBuilder PB(targetMachine);
+    PB.registerModuleAnalyses(MAM);
+    PB.registerCGSCCAnalyses(CGAM);
+    PB.registerFunctionAnalyses(FAM);
+    PB.registerLoopAnalyses(LAM);
+    PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+    llvm::ModulePassManager MPM = level == llvm::OptimizationLevel::O0 ? PB.buildO0DefaultPipeline(level)
+                                                                       : PB.buildPerModuleDefaultPipeline(level);
+    MPM.run(module, MAM);
+}
+
+bool Backend::create() {
+    m_targetMachine = create_target_machine(m_optimizationLevel);
+    return m_targetMachine != nullptr;
+}
+
+void Backend::optimize_module(llvm::Module &module) {
+    ScopedTimer(StatType::Compile_Optimize);
+    if (!m_targetMachine) dmz_unreachable("backend not created");
+
+    module.setDataLayout(m_targetMachine->createDataLayout());
+    module.setTargetTriple(m_targetMachine->getTargetTriple().str());
+    optimize_module(module, optimization_level(m_optimizationLevel), m_targetMachine.get());
+}
+
+bool Backend::emit_file(llvm::Module &module, llvm::raw_pwrite_stream &out, llvm::CodeGenFileType fileType) {
+    debug_func("");
+    ScopedTimer(StatType::Compile_Emit);
+    if (!m_targetMachine) dmz_unreachable("backend not created");
+
+    llvm::legacy::PassManager pass;
+    if (m_targetMachine->addPassesToEmitFile(pass, out, nullptr, fileType)) {
+        std::cerr << "error: the target cannot emit a file of this type\n";
+        return false;
+    }
+    pass.run(module);
+    out.flush();
+    return true;
+}
+
+bool Backend::emit_file(llvm::Module &module, const std::filesystem::path &path, llvm::CodeGenFileType fileType) {
+    std::error_code EC;
+    llvm::raw_fd_ostream out(path.string(), EC, llvm::sys::fs::OF_None);
+    if (EC) {
+        std::cerr << "error: could not open '" << path.string() << "': " << EC.message() << '\n';
+        return false;
+    }
+    return emit_file(module, out, fileType);
+}
+}  // namespace DMZ
@@ -0,0 +1,193 @@
+#include "bench/Corpus.hpp"
+
+#include "Debug.hpp"
+#include "Stats.hpp"
+#include "backend/Backend.hpp"
+#include "lsp/protocol.hpp"
+
+namespace DMZ::bench {
+
+static PhaseSummary summarize(std::vector<double> samples) {
+    PhaseSummary summary;
+    if (samples.empty()) return summary;
+    std::sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    summary.median = n % 2 == 1 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+
+    double mean = 0;
+    for (auto &&sample : samples) {
+        mean += sample / n;
+    }
+    double variance = 0;
+    for (auto &&sample : samples) {
+        variance += (sample - mean) * (sample - mean);
+    }
+    summary.stddev = std::sqrt(variance / n);
+    return summary;
+}
+
+std::vector<std::filesystem::path> CorpusBench::corpus_files() {
+    std::vector<std::filesystem::path> files;
+    for (auto &&entry : std::filesystem::recursive_directory_iterator(m_options.source)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".dmz") files.emplace_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+std::optional<std::vector<std::pair<std::string, double>>> CorpusBench::compile(const std::filesystem::path &source) {
+    auto &d = Driver::instance();
+    CompilerOptions options = m_options;
+    options.source = source;
+    // The files without main, like the ones of the standard library, are compiled as modules
+    options.isModule = true;
+    d.reset(std::move(options));
+    d.imported_modules.clear();
+    d.module_imports.clear();
+    Stats::instance().reset();
+
+    {
+        ScopedTimer(StatType::Total);
+        auto ast = d.parser_pass(d.lexer_pass(d.m_options.source));
+        if (ast) d.import_pass(ast);
+        if (!ast || d.need_exit()) return std::nullopt;
+
+        auto resolvedTree = d.semantic_pass(std::move(ast));
+        if (d.need_exit()) return std::nullopt;
+
+        auto module = d.codegen_pass(std::move(resolvedTree));
+        if (!module.second || d.need_exit()) return std::nullopt;
+
+        // The object is emitted in memory, nothing is written or linked
+        Backend backend(d.m_options.optimizationLevel);
+        if (backend.create()) {
+            ScopedTimer(StatType::Compile);
+            backend.optimize_module(*module.second);
+            llvm::SmallVector<char, 0> object;
+            llvm::raw_svector_ostream out(object);
+            if (!backend.emit_file(*module.second, out, llvm::CodeGenFileType::ObjectFile)) return std::nullopt;
+        }
+    }
+    return Stats::instance().phase_times();
+}
+
+// One result per line, so the baseline is read back line by line
+bool CorpusBench::save(const std::filesystem::path &path) {
+    std::ofstream json(path);
+    if (!json.is_open()) {
+        std::cerr << "error: failed to open '" << path.string() << "'\n";
+        return false;
+    }
+    json << "{\n  \"runs\": " << m_options.benchRuns << ",\n  \"results\": [";
+    bool first = true;
+    for (auto &&[file, phases] : m_results) {
+        for (auto &&[phase, summary] : phases) {
+            json << (first ? "" : ",") << "\n    {\"file\": \"" << lsp::escape_json(file) << "\", \"phase\": \""
+                 << phase << "\", \"median_ms\": " << std::fixed << std::setprecision(4) << summary.median
+                 << ", \"stddev_ms\": " << summary.stddev << "}";
+            first = false;
+        }
+    }
+    json << "\n  ]\n}\n";
+    return true;
+}
+
+std::optional<std::map<std::pair<std::string, std::string>, double>> CorpusBench::load_baseline(
+    const std::filesystem::path &path) {
+    std::ifstream json(path);
+    if (!json.is_open()) {
+        std::cerr << "error: failed to open '" << path.string() << "'\n";
+        return std::nullopt;
+    }
+
+    std::map<std::pair<std::string, std::string>, double> baseline;
+    std::string line;
+    while (std::getline(json, line)) {
+        if (line.find("\"file\"") == std::string::npos) continue;
+        std::string median = lsp::get_json_value(line, "median_ms");
+        double value = 0;
+        auto [end, ec] = std::from_chars(median.data(), median.data() + median.size(), value);
+        if (median.empty() || ec != std::errc()) {
+            std::cerr << "error: unexpected result in '" << path.string() << "': " << line << '\n';
+            return std::nullopt;
+        }
+        baseline[{lsp::get_json_value(line, "file"), lsp::get_json_value(line, "phase")}] = value;
+    }
+    return baseline;
+}
+
+int CorpusBench::run() {
+    debug_func(m_options.source);
+    if (!std::filesystem::is_directory(m_options.source)) {
+        std::cerr << "error: '" << m_options.source.string() << "' is not a directory\n";
+        return EXIT_FAILURE;
+    }
+
+    std::optional<std::map<std::pair<std::string, std::string>, double>> baseline;
+    if (!m_options.benchBaseline.empty()) {
+        baseline = load_baseline(m_options.benchBaseline);
+        if (!baseline) return EXIT_FAILURE;
+    }
+
+    size_t skipped = 0;
+    for (auto &&file : corpus_files()) {
+        std::string name = std::filesystem::relative(file, m_options.source).string();
+        std::vector<std::pair<std::string, std::vector<double>>> samples;
+        for (int run = 0; run < m_options.benchRuns; run++) {
+            auto times = compile(file);
+            if (!times) break;
+            if (samples.empty()) {
+                for (auto &&[phase, time] : *times) samples.emplace_back(phase, std::vector<double>{});
+            }
+            for (size_t i = 0; i < times->size(); i++) {
+                samples[i].second.emplace_back((*times)[i].second);
+            }
+        }
+        // The files that are expected to fail, like the tests of the errors, are not measured
+        if (samples.empty() || samples[0].second.size() != static_cast<size_t>(m_options.benchRuns)) {
+            std::cerr << "note: skipped '" << name << "', it does not compile\n";
+            skipped++;
+            continue;
+        }
+
+        auto &phases = m_results[name];
+        for (auto &&[phase, times] : samples) {
+            phases.emplace_back(phase, summarize(times));
+        }
+    }
+
+    println("files=" << m_results.size() << " skipped=" << skipped << " runs=" << m_options.benchRuns);
+    println(std::left << std::setw(32) << "file" << std::setw(24) << "phase" << std::right << std::setw(12)
+                      << "median ms" << std::setw(12) << "stddev ms" << (baseline ? "  baseline ms    change" : ""));
+
+    size_t regressions = 0;
+    for (auto &&[file, phases] : m_results) {
+        for (auto &&[phase, summary] : phases) {
+            if (summary.median == 0) continue;
+            std::stringstream line;
+            line << std::left << std::setw(32) << file << std::setw(24) << phase << std::right << std::fixed
+                 << std::setprecision(4) << std::setw(12) << summary.median << std::setw(12) << summary.stddev;
+
+            if (baseline) {
+                auto it = baseline->find({file, phase});
+                if (it != baseline->end() && it->second > 0) {
+                    double change = (summary.median - it->second) / it->second * 100;
+                    line << std::setw(13) << it->second << std::setprecision(1) << std::setw(9) << std::showpos
+                         << change << '%' << std::noshowpos;
+                    // A growth within twice the deviation of the runs is noise
+                    if (change > m_options.benchThreshold && summary.median - it->second > 2 * summary.stddev) {
+                        line << "  regression";
+                        regressions++;
+                    }
+                }
+            }
+            println(line.str());
+        }
+    }
+
+    if (!m_options.benchSave.empty() && !save(m_options.benchSave)) return EXIT_FAILURE;
+    if (!baseline) return EXIT_SUCCESS;
+    println(regressions << " regressions above " << m_options.benchThreshold << "%");
+    return regressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+}  // namespace DMZ::bench
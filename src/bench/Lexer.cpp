@@ -0,0 +1,65 @@
+#include "bench/Lexer.hpp"
+
+#include "Debug.hpp"
+#include "lexer/Lexer.hpp"
+#include "lexer/Scan.hpp"
+
+namespace DMZ::bench {
+
+std::vector<std::filesystem::path> LexerBench::source_files() {
+    if (!std::filesystem::is_directory(m_options.source)) return {m_options.source};
+    std::vector<std::filesystem::path> files;
+    for (auto &&entry : std::filesystem::recursive_directory_iterator(m_options.source)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".dmz") files.emplace_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+int LexerBench::run() {
+    debug_func(m_options.source);
+    if (!std::filesystem::exists(m_options.source)) {
+        std::cerr << "error: '" << m_options.source.string() << "' does not exist\n";
+        return EXIT_FAILURE;
+    }
+
+    // The sources are read once, so the runs only measure the lexer and not the file system
+    std::vector<std::pair<std::string, std::string>> sources;
+    size_t bytes = 0;
+    for (auto &&file : source_files()) {
+        std::ifstream stream(file, std::ios::binary);
+        if (!stream.is_open()) {
+            std::cerr << "error: failed to open '" << file.string() << "'\n";
+            return EXIT_FAILURE;
+        }
+        std::string content((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        bytes += content.size();
+        sources.emplace_back(file.string(), std::move(content));
+    }
+
+    size_t tokens = 0;
+    std::vector<double> times;
+    for (int run = 0; run < m_options.benchRuns; run++) {
+        tokens = 0;
+        double time = 0;
+        for (auto &&[file, content] : sources) {
+            Lexer lexer(file, content);
+            auto start = std::chrono::steady_clock::now();
+            tokens += lexer.tokenize_file().size();
+            time += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        times.emplace_back(time);
+    }
+    std::sort(times.begin(), times.end());
+    size_t n = times.size();
+    double median = n % 2 == 1 ? times[n / 2] : (times[n / 2 - 1] + times[n / 2]) / 2;
+    double best = std::max(times[0], 1e-6);
+
+    println("files=" << sources.size() << " bytes=" << bytes << " tokens=" << tokens
+                     << " runs=" << m_options.benchRuns << " scan=" << scan_isa());
+    println(std::fixed << std::setprecision(4) << "best ms " << best << " median ms " << median << std::setprecision(0)
+                       << " tokens/s " << tokens / best * 1000 << std::setprecision(2) << " MB/s "
+                       << bytes / best / 1000);
+    return EXIT_SUCCESS;
+}
+}  // namespace DMZ::bench
@@ -0,0 +1,293 @@
+#include "bench/Synthetic.hpp"
+
+#include <unistd.h>
+
+#include "Debug.hpp"
+
+namespace DMZ::bench {
+
+static const std::vector<std::string_view> dimensions = {"functions", "depth", "generics", "imports", "chain"};
+
+// Above this exponent the time of a pass grows faster than its input
+static constexpr double superLinear = 1.2;
+
+size_t *Shape::dimension(std::string_view name) {
+    if (name == "functions") return &functions;
+    if (name == "depth") return &depth;
+    if (name == "generics") return &generics;
+    if (name == "imports") return &imports;
+    if (name == "chain") return &chain;
+    return nullptr;
+}
+
+std::filesystem::path SyntheticGenerator::write(const std::filesystem::path &directory) {
+    debug_func(directory);
+    m_lines = 0;
+    m_decls = 0;
+    std::filesystem::create_directories(directory);
+    for (size_t i = 0; i < m_shape.imports; i++) {
+        std::ofstream(directory / ("mod_" + std::to_string(i) + ".dmz")) << module_source(i, false);
+    }
+    std::filesystem::path mainPath = directory / "main.dmz";
+    std::ofstream(mainPath) << module_source(m_shape.imports, true);
+    return mainPath;
+}
+
+std::string SyntheticGenerator::module_source(size_t module, bool isMain) {
+    std::stringstream out;
+    if (isMain) {
+        for (size_t i = 0; i < m_shape.imports; i++) {
+            out << "const mod_" << i << " = import(\"mod_" << i << ".dmz\");\n";
+        }
+    } else if (module > 0) {
+        out << "const mod_" << module - 1 << " = import(\"mod_" << module - 1 << ".dmz\");\n";
+    }
+    out << '\n';
+
+    if (isMain) {
+        out << "struct Box<T> {\n    value: T,\n}\n\n";
+        out << "fn wrap<T>(x: T) -> T {\n    return x;\n}\n\n";
+        m_decls += 2;
+        for (size_t i = 0; i < m_shape.generics; i++) {
+            out << "struct S_" << i << " {\n    value: i32,\n}\n\n";
+            m_decls++;
+        }
+    }
+
+    // The first function of a module calls the module it imports, so every module is reachable from main
+    std::string importCall = !isMain && module > 0 ? "mod_" + std::to_string(module - 1) + ".f_0" : "";
+    for (size_t i = 0; i < m_shape.functions; i++) {
+        function_source(out, i, !isMain, i == 0 ? importCall : "");
+    }
+
+    if (isMain) {
+        out << "fn main() -> void {\n    let acc = 0;\n";
+        if (m_shape.functions > 0) out << "    acc = f_0(acc);\n";
+        for (size_t i = 0; i < m_shape.imports && m_shape.functions > 0; i++) {
+            out << "    acc = mod_" << i << ".f_0(acc);\n";
+        }
+        for (size_t i = 0; i < m_shape.generics; i++) {
+            out << "    let b_" << i << " = Box<S_" << i << ">{value: wrap<S_" << i << ">(S_" << i
+                << "{value: acc})};\n";
+            out << "    acc = acc + b_" << i << ".value.value;\n";
+        }
+        out << "}\n";
+        m_decls++;
+    }
+
+    std::string source = out.str();
+    m_lines += std::count(source.begin(), source.end(), '\n');
+    return source;
+}
+
+void SyntheticGenerator::function_source(std::ostream &out, size_t function, bool isPublic, std::string_view call) {
+    m_decls++;
+    out << (isPublic ? "pub " : "") << "fn f_" << function << "(x: i32) -> i32 {\n";
+    out << "    let v = x;\n";
+
+    // Nested ifs and whiles
+    for (size_t level = 0; level < m_shape.depth; level++) {
+        out << std::string(4 * (level + 1), ' ') << (level % 2 == 0 ? "if" : "while") << " (v > " << level << ") {\n";
+    }
+    if (m_shape.depth > 0) out << std::string(4 * (m_shape.depth + 1), ' ') << "v = v - 1;\n";
+    for (size_t level = m_shape.depth; level > 0; level--) {
+        out << std::string(4 * level, ' ') << "}\n";
+    }
+
+    if (m_shape.chain > 0) {
+        out << "    switch (v) {\n";
+        for (size_t i = 0; i < m_shape.chain; i++) {
+            out << "        case " << i << " => v = v + " << i + 1 << ";\n";
+        }
+        out << "        else => v = v - 1;\n    }\n";
+
+        for (size_t i = 0; i < m_shape.chain; i++) {
+            out << (i == 0 ? "    if" : " else if") << " (v == " << i << ") {\n";
+            out << "        v = v + " << i + 1 << ";\n    }";
+        }
+        out << " else {\n        v = v - 1;\n    }\n";
+    }
+
+    if (!call.empty()) out << "    v = " << call << "(v);\n";
+    // Every function calls the next one, so none of them is removed as unused
+    if (function + 1 < m_shape.functions) out << "    v = f_" << function + 1 << "(v);\n";
+    out << "    return v;\n}\n\n";
+}
+
+bool SyntheticBench::parse_shape(const std::string &spec) {
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) continue;
+        auto equal = item.find('=');
+        size_t value = 0;
+        std::string_view number = equal == std::string::npos ? "" : std::string_view(item).substr(equal + 1);
+        auto [end, ec] = std::from_chars(number.data(), number.data() + number.size(), value);
+        if (number.empty() || ec != std::errc() || end != number.data() + number.size()) {
+            std::cerr << "error: expected '<dimension>=<number>' in the shape, found '" << item << "'\n";
+            return false;
+        }
+
+        std::string name = item.substr(0, equal);
+        if (name == "steps") {
+            m_steps = std::max<size_t>(value, 1);
+        } else if (name == "runs") {
+            m_runs = std::max<size_t>(value, 1);
+        } else if (auto *dimension = m_shape.dimension(name)) {
+            *dimension = value;
+        } else {
+            std::cerr << "error: unknown shape dimension '" << name << "'\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+std::optional<PhaseTimes> SyntheticBench::compile(const std::filesystem::path &source) {
+    using clock = std::chrono::steady_clock;
+    auto elapsed = [](clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    };
+
+    auto &d = Driver::instance();
+    CompilerOptions options;
+    // The imports are registered by their canonical path, the lexed sources are found by it
+    options.source = std::filesystem::canonical(source);
+    options.parallelJobs = m_options.parallelJobs;
+    d.reset(std::move(options));
+    d.imported_modules.clear();
+    d.module_imports.clear();
+    d.lexed_sources.clear();
+    defer([&] { d.lexed_sources.clear(); });
+
+    std::vector<std::filesystem::path> sources;
+    for (auto &&entry : std::filesystem::directory_iterator(source.parent_path())) {
+        sources.emplace_back(std::filesystem::canonical(entry.path()));
+    }
+
+    PhaseTimes times;
+    auto start = clock::now();
+    for (auto &&path : sources) {
+        Lexer lexer(path.string());
+        auto tokens = lexer.tokenize_file();
+        d.lexed_sources.emplace(path, std::make_pair(std::move(tokens), lexer.take_buffer()));
+    }
+    times.lex = elapsed(start);
+
+    // The parser replays the tokens lexed above, so the lexer is not timed twice
+    start = clock::now();
+    auto ast = d.parser_pass(d.lexer_pass(d.m_options.source));
+    if (ast) d.import_pass(ast);
+    times.parse = elapsed(start);
+    if (!ast || d.need_exit()) return std::nullopt;
+
+    start = clock::now();
+    auto resolvedTree = d.semantic_pass(std::move(ast));
+    times.sema = elapsed(start);
+    if (d.need_exit()) return std::nullopt;
+
+    start = clock::now();
+    auto module = d.codegen_pass(std::move(resolvedTree));
+    times.codegen = elapsed(start);
+    if (!module.second || d.need_exit()) return std::nullopt;
+    return times;
+}
+
+// Best time of every pass over the runs
+std::optional<PhaseTimes> SyntheticBench::measure(const std::filesystem::path &source) {
+    std::optional<PhaseTimes> best;
+    for (size_t i = 0; i < m_runs; i++) {
+        auto times = compile(source);
+        if (!times) return std::nullopt;
+        if (!best) {
+            best = times;
+            continue;
+        }
+        best->lex = std::min(best->lex, times->lex);
+        best->parse = std::min(best->parse, times->parse);
+        best->sema = std::min(best->sema, times->sema);
+        best->codegen = std::min(best->codegen, times->codegen);
+    }
+    return best;
+}
+
+// Slope of the least squares fit of log(time) over log(lines), 1 is linear
+static double scaling_exponent(const std::vector<double> &lines, const std::vector<double> &times) {
+    size_t n = lines.size();
+    double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+    for (size_t i = 0; i < n; i++) {
+        double x = std::log(lines[i]);
+        double y = std::log(std::max(times[i], 1e-6));
+        sumX += x;
+        sumY += y;
+        sumXX += x * x;
+        sumXY += x * y;
+    }
+    double denominator = n * sumXX - sumX * sumX;
+    if (n < 2 || denominator == 0) return 0;
+    return (n * sumXY - sumX * sumY) / denominator;
+}
+
+int SyntheticBench::run() {
+    debug_func(m_options.benchShape);
+    if (!parse_shape(m_options.benchShape)) return EXIT_FAILURE;
+
+    std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / ("dmz-bench-" + std::to_string(getpid()));
+    defer([&] {
+        std::error_code ec;
+        std::filesystem::remove_all(directory, ec);
+    });
+
+    println("functions=" << m_shape.functions << " depth=" << m_shape.depth << " generics=" << m_shape.generics
+                         << " imports=" << m_shape.imports << " chain=" << m_shape.chain << " (best of " << m_runs
+                         << " runs)");
+
+    for (auto &&name : dimensions) {
+        std::vector<double> lines;
+        std::vector<std::vector<double>> passTimes(4);
+
+        println("");
+        println(std::left << std::setw(10) << name << std::right << std::setw(8) << "lines" << std::setw(8) << "decls"
+                          << std::setw(10) << "lex ms" << std::setw(10) << "parse ms" << std::setw(10) << "sema ms"
+                          << std::setw(12) << "codegen ms" << std::setw(12) << "lines/s" << std::setw(12)
+                          << "decls/s");
+        for (size_t step = 0; step < m_steps; step++) {
+            Shape shape = m_shape;
+            size_t &dimension = *shape.dimension(name);
+            dimension = std::max<size_t>(dimension, 1) << step;
+
+            SyntheticGenerator generator(shape);
+            auto source = generator.write(directory / (std::string(name) + "-" + std::to_string(dimension)));
+            auto times = measure(source);
+            if (!times) {
+                std::cerr << "error: failed to compile the generated program '" << source.string() << "'\n";
+                return EXIT_FAILURE;
+            }
+
+            double seconds = times->total() / 1000;
+            lines.emplace_back(generator.lines());
+            passTimes[0].emplace_back(times->lex);
+            passTimes[1].emplace_back(times->parse);
+            passTimes[2].emplace_back(times->sema);
+            passTimes[3].emplace_back(times->codegen);
+            println(std::left << std::setw(10) << dimension << std::right << std::setw(8) << generator.lines()
+                              << std::setw(8) << generator.decls() << std::fixed << std::setprecision(3)
+                              << std::setw(10) << times->lex << std::setw(10) << times->parse << std::setw(10)
+                              << times->sema << std::setw(12) << times->codegen << std::setprecision(0)
+                              << std::setw(12) << generator.lines() / seconds << std::setw(12)
+                              << generator.decls() / seconds);
+        }
+
+        std::stringstream scaling;
+        const char *passes[] = {"lex", "parse", "sema", "codegen"};
+        for (size_t i = 0; i < 4; i++) {
+            double exponent = scaling_exponent(lines, passTimes[i]);
+            scaling << "  " << passes[i] << ' ' << std::fixed << std::setprecision(2) << exponent
+                    << (exponent > superLinear ? " (super-linear)" : "");
+        }
+        println(std::left << std::setw(10) << "scaling" << scaling.str());
+    }
+    return EXIT_SUCCESS;
+}
+}  // namespace DMZ::bench
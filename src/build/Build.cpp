@@ -0,0 +1,284 @@
+#include "build/Build.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Debug.hpp"
+#include "cache/Cache.hpp"
+
+namespace DMZ::build {
+
+static std::string to_hex(uint64_t value) {
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << value;
+    return ss.str();
+}
+
+ProjectBuild::ProjectBuild(CompilerOptions options) : m_options(std::move(options)) {
+    m_projectDir = m_options.source;
+    m_outputDir = m_options.output.empty() ? m_projectDir / "build" : m_options.output;
+}
+
+bool ProjectBuild::read_manifest() {
+    debug_func("");
+    std::filesystem::path manifest = m_projectDir / "dmz.build";
+    std::ifstream file(manifest);
+    if (!file) {
+        std::cerr << "error: failed to open '" << manifest.string() << "'\n";
+        return false;
+    }
+
+    std::unordered_set<std::string> names;
+    std::string line;
+    uint32_t manifestId = SourceManager::instance().file_id(manifest.string());
+    uint32_t lineNum = 0;
+    while (std::getline(file, line)) {
+        lineNum++;
+        SourceLocation loc = {.file_id = manifestId, .line = lineNum, .col = 1};
+        if (auto comment = line.find('#'); comment != std::string::npos) line.resize(comment);
+
+        std::stringstream ss(line);
+        std::string kind, name, source, extra;
+        if (!(ss >> kind)) continue;
+        if (!(ss >> name >> source) || (ss >> extra)) {
+            report(loc, "expected '<exe|module> <name> <source>'");
+            return false;
+        }
+
+        Target target;
+        if (kind == "exe") {
+            target.kind = Target::Kind::Executable;
+            target.output = m_outputDir / name;
+        } else if (kind == "module") {
+            target.kind = Target::Kind::Module;
+            target.output = m_outputDir / (name + ".o");
+        } else {
+            report(loc, "unexpected target kind '" + kind + "'");
+            return false;
+        }
+        if (!names.emplace(name).second) {
+            report(loc, "duplicated target '" + name + "'");
+            return false;
+        }
+        target.name = name;
+        target.source = m_projectDir / source;
+        if (!std::filesystem::exists(target.source)) {
+            report(loc, "failed to open '" + target.source.string() + "'");
+            return false;
+        }
+        target.source = std::filesystem::canonical(target.source);
+        m_targets.emplace_back(std::move(target));
+    }
+    return true;
+}
+
+// Follows the imports of the source the same way the driver registers them, without parsing the modules
+std::vector<std::filesystem::path> ProjectBuild::scan_imports(const std::filesystem::path &source) {
+    debug_func(source);
+    std::vector<std::filesystem::path> modules = {source};
+    std::unordered_set<std::filesystem::path> visited = {source};
+
+    for (size_t i = 0; i < modules.size(); i++) {
+        Lexer lexer(modules[i].string());
+        auto tokens = lexer.tokenize_file();
+        for (size_t j = 0; j + 2 < tokens.size(); j++) {
+            if (tokens[j].type != TokenType::kw_import || tokens[j + 1].type != TokenType::par_l ||
+                tokens[j + 2].type != TokenType::lit_string) {
+                continue;
+            }
+
+            std::string imported(tokens[j + 2].str.substr(1, tokens[j + 2].str.size() - 2));
+            std::filesystem::path module_path;
+            if (imported.ends_with(".dmz")) {
+                module_path = modules[i].parent_path() / imported;
+            } else if (auto it = m_options.imports.find(imported); it != m_options.imports.end()) {
+                module_path = it->second;
+            } else if (imported == "std") {
+                module_path = source.parent_path() / "std" / "std.dmz";
+                if (!std::filesystem::exists(module_path)) module_path = std::filesystem::absolute("std/std.dmz");
+            }
+            // The missing modules are reported by the compiler of the target
+            if (module_path.empty() || !std::filesystem::exists(module_path)) continue;
+
+            module_path = std::filesystem::canonical(module_path);
+            if (visited.emplace(module_path).second) modules.emplace_back(module_path);
+        }
+    }
+    return modules;
+}
+
+bool ProjectBuild::resolve_dependencies() {
+    debug_func("");
+    std::unordered_map<std::filesystem::path, size_t> moduleTargets;
+    for (size_t i = 0; i < m_targets.size(); i++) {
+        if (m_targets[i].kind == Target::Kind::Module) moduleTargets.emplace(m_targets[i].source, i);
+    }
+
+    for (size_t i = 0; i < m_targets.size(); i++) {
+        auto &target = m_targets[i];
+        target.inputs = scan_imports(target.source);
+        for (auto &&input : target.inputs) {
+            auto it = moduleTargets.find(input);
+            if (it != moduleTargets.end() && it->second != i) target.dependencies.emplace_back(it->second);
+        }
+    }
+
+    // The modules that import each other cannot be ordered
+    std::vector<int> state(m_targets.size(), 0);
+    std::function<bool(size_t)> visit = [&](size_t i) {
+        if (state[i] == 2) return true;
+        if (state[i] == 1) {
+            std::cerr << "error: cyclic dependency on target '" << m_targets[i].name << "'\n";
+            return false;
+        }
+        state[i] = 1;
+        for (auto &&dep : m_targets[i].dependencies) {
+            if (!visit(dep)) return false;
+        }
+        state[i] = 2;
+        return true;
+    };
+    for (size_t i = 0; i < m_targets.size(); i++) {
+        if (!visit(i)) return false;
+    }
+    return true;
+}
+
+std::vector<std::string> ProjectBuild::target_arguments(const Target &target) {
+    std::vector<std::string> args = {target.source.string()};
+    if (target.kind == Target::Kind::Module) args.emplace_back("-module");
+    args.emplace_back("-o");
+    args.emplace_back(target.output.string());
+    args.emplace_back(m_options.optimizationLevel);
+    if (m_options.debugSymbols) args.emplace_back("-g");
+    std::map<std::string, std::filesystem::path> imports(m_options.imports.begin(), m_options.imports.end());
+    for (auto &&[k, v] : imports) {
+        args.emplace_back("-I");
+        args.emplace_back(k);
+        args.emplace_back(v.string());
+    }
+    if (m_options.cache) {
+        args.emplace_back("-cache-dir");
+        args.emplace_back(m_options.cacheDir.string());
+    }
+    return args;
+}
+
+// Hash of everything the output of the target depends on
+std::string ProjectBuild::input_stamp(const Target &target) {
+    uint64_t hash = hash_fnv1a(to_hex(Cache::compiler_hash()));
+    for (auto &&arg : target_arguments(target)) {
+        hash = hash_fnv1a(arg, hash);
+    }
+    for (auto &&input : target.inputs) {
+        hash = hash_fnv1a(input.string(), hash);
+        hash = hash_fnv1a(to_hex(Cache::hash_file(input).value_or(0)), hash);
+    }
+    return to_hex(hash);
+}
+
+std::filesystem::path ProjectBuild::stamp_path(const Target &target) {
+    return m_outputDir / ".dmz-build" / (target.name + ".stamp");
+}
+
+int ProjectBuild::run() {
+    debug_func(m_projectDir);
+    if (!read_manifest() || !resolve_dependencies()) return EXIT_FAILURE;
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_outputDir / ".dmz-build", ec);
+    if (ec) {
+        std::cerr << "error: cannot create '" << m_outputDir.string() << "': " << ec.message() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    std::string compiler = std::filesystem::read_symlink("/proc/self/exe", ec).string();
+    if (ec) {
+        std::cerr << "error: cannot find the compiler executable: " << ec.message() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    enum class State { Pending, Running, Done };
+    std::vector<State> states(m_targets.size(), State::Pending);
+    std::vector<std::string> stamps(m_targets.size());
+    std::unordered_map<pid_t, size_t> running;
+    size_t maxJobs = m_options.parallelJobs <= 0 ? std::thread::hardware_concurrency() : m_options.parallelJobs;
+    size_t done = 0, built = 0;
+    bool failed = false;
+
+    while (done < m_targets.size()) {
+        // Start every target whose modules are built, until the jobs are used
+        for (size_t i = 0; i < m_targets.size() && !failed && running.size() < maxJobs; i++) {
+            if (states[i] != State::Pending) continue;
+            auto &target = m_targets[i];
+            bool ready = std::all_of(target.dependencies.begin(), target.dependencies.end(),
+                                     [&](size_t dep) { return states[dep] == State::Done; });
+            if (!ready) continue;
+
+            stamps[i] = input_stamp(target);
+            std::ifstream stampFile(stamp_path(target));
+            std::string previous;
+            if (std::filesystem::exists(target.output) && std::getline(stampFile, previous) && previous == stamps[i]) {
+                debug_msg(target.name << " is up to date");
+                states[i] = State::Done;
+                done++;
+                continue;
+            }
+
+            auto arguments = target_arguments(target);
+            std::vector<const char *> args = {compiler.c_str()};
+            for (auto &&arg : arguments) {
+                args.emplace_back(arg.c_str());
+            }
+            args.emplace_back(nullptr);
+
+            pid_t pid = fork();
+            if (pid == -1) {
+                perror("fork");
+                failed = true;
+                break;
+            }
+            if (pid == 0) {
+                execv(args[0], const_cast<char *const *>(args.data()));
+                perror("execv");
+                _exit(EXIT_FAILURE);
+            }
+            states[i] = State::Running;
+            running.emplace(pid, i);
+            built++;
+            if (!m_options.quiet) {
+                const char *kind = target.kind == Target::Kind::Module ? "module" : "exe";
+                println("[" << built << "] " << kind << ' ' << target.name);
+            }
+        }
+
+        if (running.empty()) break;
+
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid == -1) {
+            if (errno == EINTR) continue;
+            perror("waitpid");
+            return EXIT_FAILURE;
+        }
+        auto it = running.find(pid);
+        if (it == running.end()) continue;
+        size_t i = it->second;
+        running.erase(it);
+
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            std::cerr << "error: failed to build target '" << m_targets[i].name << "'\n";
+            std::filesystem::remove(stamp_path(m_targets[i]), ec);
+            failed = true;
+            continue;
+        }
+        std::ofstream(stamp_path(m_targets[i])) << stamps[i] << '\n';
+        states[i] = State::Done;
+        done++;
+    }
+
+    if (failed) return EXIT_FAILURE;
+    if (!m_options.quiet) println(built << " built, " << m_targets.size() - built << " up to date");
+    return EXIT_SUCCESS;
+}
+}  // namespace DMZ::build
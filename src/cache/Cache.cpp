@@ -0,0 +1,148 @@
+#include "cache/Cache.hpp"
+
+#include "Debug.hpp"
+#include "Stats.hpp"
+
+namespace DMZ {
+static constexpr std::string_view s_entryHeader = "dmz-cache 2";
+
+static std::string to_hex(uint64_t value) {
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << value;
+    return ss.str();
+}
+
+Cache::Cache(std::filesystem::path directory, const std::filesystem::path &source, std::string_view configuration)
+    : m_directory(std::move(directory)) {
+    uint64_t key = hash_fnv1a(to_hex(compiler_hash()));
+    key = hash_fnv1a(configuration, key);
+    key = hash_fnv1a(std::filesystem::absolute(source).string(), key);
+    m_key = to_hex(key);
+}
+
+std::filesystem::path Cache::module_path(const std::filesystem::path &directory, const std::filesystem::path &module,
+                                        std::string_view configuration) {
+    uint64_t key = hash_fnv1a(to_hex(compiler_hash()));
+    key = hash_fnv1a(configuration, key);
+    std::filesystem::path path = std::filesystem::absolute(directory) / "modules" / to_hex(key);
+    return path / (module.stem().string() + "-" + to_hex(hash_fnv1a(std::filesystem::absolute(module).string())) +
+                   module.extension().string());
+}
+
+std::optional<uint64_t> Cache::hash_file(const std::filesystem::path &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return std::nullopt;
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return hash_fnv1a(content);
+}
+
+uint64_t Cache::compiler_hash() {
+    // The size and modification time of the running binary are enough to tell two builds of the compiler apart
+    static uint64_t hash = [] {
+        std::error_code ec;
+        std::filesystem::path exe = std::filesystem::read_symlink("/proc/self/exe", ec);
+        std::string identity = exe.string();
+        if (!ec) {
+            identity += ":" + std::to_string(std::filesystem::file_size(exe, ec));
+            identity += ":" + std::to_string(std::filesystem::last_write_time(exe, ec).time_since_epoch().count());
+        }
+        return hash_fnv1a(identity);
+    }();
+    return hash;
+}
+
+ptr<llvm::Module> Cache::load(llvm::LLVMContext &context) {
+    debug_func(m_key);
+    ScopedTimer(StatType::Cache);
+
+    m_modules.clear();
+    m_objects.clear();
+    std::ifstream entry(entry_path(), std::ios::binary);
+    if (!entry) return nullptr;
+
+    std::string line;
+    if (!std::getline(entry, line) || line != s_entryHeader) return nullptr;
+
+    size_t bitcodeSize = 0;
+    while (std::getline(entry, line)) {
+        if (line.starts_with("bitcode ")) {
+            bitcodeSize = std::stoull(line.substr(8));
+            break;
+        }
+        if (line.starts_with("object ")) {
+            std::filesystem::path object = line.substr(7);
+            if (!std::filesystem::exists(object)) {
+                debug_msg("stale cache entry " << m_key << ", missing object " << object);
+                return nullptr;
+            }
+            m_objects.emplace_back(std::move(object));
+            continue;
+        }
+        if (!line.starts_with("module ")) return nullptr;
+
+        // module <hash> <path>
+        auto hashEnd = line.find(' ', 7);
+        if (hashEnd == std::string::npos) return nullptr;
+        std::filesystem::path path = line.substr(hashEnd + 1);
+        auto hash = hash_file(path);
+        if (!hash || to_hex(*hash) != line.substr(7, hashEnd - 7)) {
+            debug_msg("stale cache entry " << m_key << ", changed module " << path);
+            return nullptr;
+        }
+        m_modules.emplace_back(std::move(path));
+    }
+    if (bitcodeSize == 0) return nullptr;
+
+    std::string bitcode(bitcodeSize, '\0');
+    if (!entry.read(bitcode.data(), bitcodeSize)) return nullptr;
+
+    auto module = llvm::parseBitcodeFile(llvm::MemoryBufferRef(bitcode, m_key), context);
+    if (!module) {
+        llvm::consumeError(module.takeError());
+        return nullptr;
+    }
+    if (Stats::enabled()) Stats::instance().add_count(CounterType::CacheHits, 1);
+    return std::move(*module);
+}
+
+bool Cache::store(const std::vector<std::filesystem::path> &modules, const std::vector<std::filesystem::path> &objects,
+                  const llvm::Module &module) {
+    debug_func(m_key);
+    ScopedTimer(StatType::Cache);
+
+    std::string entry = std::string(s_entryHeader) + "\n";
+    for (auto &&path : modules) {
+        auto hash = hash_file(path);
+        if (!hash) return false;
+        entry += "module " + to_hex(*hash) + " " + path.string() + "\n";
+    }
+    for (auto &&object : objects) {
+        entry += "object " + std::filesystem::absolute(object).string() + "\n";
+    }
+
+    std::string bitcode;
+    llvm::raw_string_ostream out(bitcode);
+    llvm::WriteBitcodeToFile(module, out);
+    out.flush();
+    entry += "bitcode " + std::to_string(bitcode.size()) + "\n";
+    entry += bitcode;
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+    if (ec) return false;
+
+    // Write a private file and rename it over the entry so a concurrent compiler never reads a partial entry
+    std::filesystem::path tmpPath = m_directory / (m_key + "." + std::to_string(getpid()) + ".tmp");
+    bool written;
+    {
+        std::ofstream file(tmpPath, std::ios::binary);
+        written = static_cast<bool>(file.write(entry.data(), entry.size()));
+    }
+    if (written) std::filesystem::rename(tmpPath, entry_path(), ec);
+    if (!written || ec) {
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+}  // namespace DMZ
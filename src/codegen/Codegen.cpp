@@ -11,7 +11,8 @@
 
 namespace DMZ {
 Codegen::Codegen(std::vector<ptr<ResolvedModuleDecl>> resolvedTree, std::string_view sourcePath, bool debugSymbols)
-    : m_resolvedTree(move_vector_ptr<ResolvedModuleDecl, ResolvedDecl>(resolvedTree)),
+    : m_ownedTree(move_vector_ptr<ResolvedModuleDecl, ResolvedDecl>(resolvedTree)),
+      m_resolvedTree(m_ownedTree),
       m_context(makePtr<llvm::LLVMContext>()),
       m_builder(*m_context),
       m_module(makePtr<llvm::Module>("<translation_unit>", *m_context)),
@@ -21,22 +22,42 @@ Codegen::Codegen(std::vector<ptr<ResolvedModuleDecl>> resolvedTree, std::string_
     m_module->setTargetTriple(llvm::sys::getDefaultTargetTriple());
 }
 
-std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>> Codegen::generate_ir(bool runTest) {
+Codegen::Codegen(const std::vector<ptr<ResolvedDecl>> &resolvedTree, const ResolvedModuleDecl &ownedModule,
+                 std::string_view sourcePath, bool debugSymbols)
+    : m_resolvedTree(resolvedTree),
+      m_ownedModule(&ownedModule),
+      m_context(makePtr<llvm::LLVMContext>()),
+      m_builder(*m_context),
+      m_module(makePtr<llvm::Module>(ownedModule.module_path.string(), *m_context)),
+      m_debugBuilder(*m_module),
+      m_debugSymbols(debugSymbols) {
+    m_module->setSourceFileName(sourcePath);
+    m_module->setTargetTriple(llvm::sys::getDefaultTargetTriple());
+}
+
+std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>> Codegen::generate_ir(bool runTest, bool runBench) {
     debug_func("");
-    ScopedTimer(StatType::Codegen);
+    // A module generated on its own is reported by name below the whole codegen
+    ScopedNamedTimer(StatType::Codegen, m_ownedModule ? m_ownedModule->module_path.filename().string() : "");
 
     if (m_debugSymbols) {
-        m_debugBuilder.createCompileUnit(llvm::dwarf::DW_LANG_C, generate_debug_file(m_resolvedTree.back()->location),
+        const SourceLocation &unitLocation = m_ownedModule ? m_ownedModule->location : m_resolvedTree.back()->location;
+        m_debugBuilder.createCompileUnit(llvm::dwarf::DW_LANG_C, generate_debug_file(unitLocation),
                                          "dmz Compiler", false, "", 0);
 
         m_module->addModuleFlag(llvm::Module::Warning, "Debug Info Version", llvm::DEBUG_METADATA_VERSION);
         m_module->addModuleFlag(llvm::Module::Warning, "Dwarf Version", llvm::dwarf::DWARF_VERSION);
     }
 
+    m_linksInterfaces = std::any_of(m_resolvedTree.begin(), m_resolvedTree.end(), [](const ptr<ResolvedDecl> &decl) {
+        auto *moduleDecl = dynamic_cast<const ResolvedModuleDecl *>(decl.get());
+        return moduleDecl && !moduleDecl->interfaceObject.empty();
+    });
+
     generate_in_module_decl(m_resolvedTree);
     generate_in_module_body(m_resolvedTree);
 
-    generate_main_wrapper(runTest);
+    generate_main_wrapper(runTest, runBench);
     if (m_debugSymbols) {
         m_debugBuilder.finalize();
     }
@@ -426,7 +447,7 @@ llvm::DIType *Codegen::generate_debug_type(const ResolvedType &type) {
 
 llvm::DIFile *Codegen::generate_debug_file(const SourceLocation &location) {
     debug_func("");
-    auto path = std::filesystem::path(location.file_name);
+    auto path = std::filesystem::path(location.file_name());
     path = std::filesystem::canonical(path);
     return m_debugBuilder.createFile(path.filename().string(), path.parent_path().string());
 }
@@ -474,14 +495,18 @@ llvm::AllocaInst *Codegen::allocate_stack_variable(const SourceLocation &locatio
     return value;
 }
 
-void Codegen::generate_main_wrapper(bool runTest) {
+void Codegen::generate_main_wrapper(bool runTest, bool runBench) {
     debug_func("");
     std::string mainToCall = "__builtin_main";
     if (runTest) {
         mainToCall = "__builtin_main_test";
+    } else if (runBench) {
+        mainToCall = "__builtin_main_bench";
     }
     auto *builtinMain = m_module->getFunction(mainToCall);
     if (!builtinMain) return;
+    // With one llvm module per dmz module the wrapper goes next to the definition
+    if (m_ownedModule && builtinMain->isDeclaration()) return;
 
     auto *main = llvm::Function::Create(llvm::FunctionType::get(m_builder.getInt32Ty(), {}, false),
                                         llvm::Function::ExternalLinkage, "main", *m_module);
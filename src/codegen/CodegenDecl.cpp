@@ -5,6 +5,7 @@
 #endif
 
 #include "Debug.hpp"
+#include "Stats.hpp"
 #include "codegen/Codegen.hpp"
 
 namespace DMZ {
@@ -17,7 +18,7 @@ std::string Codegen::generate_decl_name(const ResolvedDecl &decl) {
             name = "__builtin_main";
             return name;
         }
-        if (decl.identifier == "__builtin_main_test") {
+        if (decl.identifier == "__builtin_main_test" || decl.identifier == "__builtin_main_bench") {
             name = decl.identifier;
             return name;
         }
@@ -122,6 +123,8 @@ llvm::AttributeList Codegen::construct_attr_list(const ResolvedTypeFunction &fnT
 
 void Codegen::generate_function_body(const ResolvedFuncDecl &functionDecl) {
     debug_func(functionDecl.name() << " " << functionDecl.type->to_str());
+    dmz_profile_scope_args("Generate function", functionDecl.identifier);
+    if (!m_emitBodies) return;
     if (auto resolvedFunctionDecl = dynamic_cast<const ResolvedGenericFunctionDecl *>(&functionDecl)) {
         for (auto &&func : resolvedFunctionDecl->specializations) {
             auto cast_func = dynamic_cast<ResolvedFuncDecl *>(func.get());
@@ -137,12 +140,19 @@ void Codegen::generate_function_body(const ResolvedFuncDecl &functionDecl) {
         return;
     }
 
+    // Declared by a module interface, the body is in the module object
+    if (auto fn = dynamic_cast<const ResolvedFunctionDecl *>(&functionDecl)) {
+        if (!fn->body && m_currentModule && !m_currentModule->interfaceObject.empty()) return;
+    }
+
+    ScopedDeclTimer(&functionDecl, functionDecl.name(), nullptr, true);
     auto fnType = functionDecl.getFnType();
 
     m_currentFunction = &functionDecl;
     std::string funcName = generate_decl_name(functionDecl);
     auto *function = m_module->getFunction(funcName);
     if (!function) dmz_unreachable("internal error no function '" + funcName + "'");
+    function->setLinkage(function_linkage(functionDecl));
 
     ptr<DebugScopeRAII> debugScope = nullptr;
     if (m_debugSymbols) {
@@ -389,14 +399,35 @@ void Codegen::generate_union_functions(const ResolvedUnionDecl &unionDecl) {
     }
 }
 
+llvm::GlobalValue::LinkageTypes Codegen::error_linkage() const {
+    // Errors are compared by address, every llvm module must end up pointing to the same string
+    return m_ownedModule || !m_exportedModules.empty() || m_linksInterfaces
+               ? llvm::GlobalValue::LinkageTypes::LinkOnceODRLinkage
+               : llvm::GlobalValue::LinkageTypes::PrivateLinkage;
+}
+
+llvm::GlobalValue::LinkageTypes Codegen::function_linkage(const ResolvedFuncDecl &functionDecl) const {
+    if (m_exportedModules.empty()) return llvm::GlobalValue::LinkageTypes::ExternalLinkage;
+
+    // A module object owns the functions of its sources, the ones of other modules, the specializations and the
+    // builtins can also be emitted by the programs that import it
+    bool specialized = dynamic_cast<const ResolvedSpecializedFunctionDecl *>(&functionDecl);
+    if (auto member = dynamic_cast<const ResolvedMemberFunctionDecl *>(&functionDecl)) {
+        specialized |= dynamic_cast<const ResolvedSpecializedStructDecl *>(member->parentDecl) != nullptr;
+    }
+    if (specialized || functionDecl.identifier.starts_with('@') || !m_exportedModules.contains(m_currentModule)) {
+        return llvm::GlobalValue::LinkageTypes::LinkOnceODRLinkage;
+    }
+    return llvm::GlobalValue::LinkageTypes::ExternalLinkage;
+}
+
 void Codegen::generate_error_no_err() {
     debug_func("");
     if (m_success) return;
     std::string str("SUCCESS");
     llvm::Constant *stringConst = llvm::ConstantDataArray::getString(*m_context, str, true);
-    m_success =
-        new llvm::GlobalVariable(*m_module, stringConst->getType(), true,
-                                 llvm::GlobalVariable::LinkageTypes::PrivateLinkage, stringConst, "error.str." + str);
+    m_success = new llvm::GlobalVariable(*m_module, stringConst->getType(), true, error_linkage(), stringConst,
+                                         "error.str." + str);
 }
 
 void Codegen::generate_error_group_expr_decl(const ResolvedErrorGroupExprDecl &ErrorGroupExprDecl) {
@@ -406,8 +437,8 @@ void Codegen::generate_error_group_expr_decl(const ResolvedErrorGroupExprDecl &E
         auto global = m_module->getNamedGlobal(errName);
         if (!global) {
             llvm::Constant *stringConst = llvm::ConstantDataArray::getString(*m_context, error->identifier, true);
-            global = new llvm::GlobalVariable(*m_module, stringConst->getType(), true,
-                                              llvm::GlobalVariable::LinkageTypes::PrivateLinkage, stringConst, errName);
+            global = new llvm::GlobalVariable(*m_module, stringConst->getType(), true, error_linkage(), stringConst,
+                                              errName);
         }
         m_declarations[error.get()] = global;
     }
@@ -418,6 +449,9 @@ void Codegen::generate_module_decl(const ResolvedModuleDecl &moduleDecl) {
     auto prevModule = m_currentModule;
     defer([&]() mutable { m_currentModule = prevModule; });
     m_currentModule = &moduleDecl;
+    auto prevEmitBodies = m_emitBodies;
+    defer([&]() mutable { m_emitBodies = prevEmitBodies; });
+    if (m_ownedModule && is_owned_module(moduleDecl)) m_emitBodies = &moduleDecl == m_ownedModule;
     ptr<DebugScopeRAII> debugScope = nullptr;
     if (m_debugSymbols) {
         m_currentDebugFile = m_debugBuilder.createFile(moduleDecl.module_path.filename().string(),
@@ -427,11 +461,21 @@ void Codegen::generate_module_decl(const ResolvedModuleDecl &moduleDecl) {
     generate_in_module_decl(moduleDecl.declarations);
 }
 
+bool Codegen::is_owned_module(const ResolvedModuleDecl &moduleDecl) const {
+    // Only the top level modules (one per source file) are split between the llvm modules
+    return std::any_of(m_resolvedTree.begin(), m_resolvedTree.end(),
+                       [&](const ptr<ResolvedDecl> &decl) { return decl.get() == &moduleDecl; });
+}
+
 void Codegen::generate_module_body(const ResolvedModuleDecl &moduleDecl) {
     debug_func("");
+    dmz_profile_scope_args("Generate module", moduleDecl.module_path);
     auto prevModule = m_currentModule;
     defer([&]() mutable { m_currentModule = prevModule; });
     m_currentModule = &moduleDecl;
+    auto prevEmitBodies = m_emitBodies;
+    defer([&]() mutable { m_emitBodies = prevEmitBodies; });
+    if (m_ownedModule && is_owned_module(moduleDecl)) m_emitBodies = &moduleDecl == m_ownedModule;
     ptr<DebugScopeRAII> debugScope = nullptr;
     if (m_debugSymbols) {
         m_currentDebugFile = m_debugBuilder.createFile(moduleDecl.module_path.filename().string(),
@@ -545,9 +589,28 @@ void Codegen::generate_global_var_decl(const ResolvedDeclStmt &stmt) {
     if (auto constVal = stmt.varDecl->initializer->get_constant_value()) {
         initializer = m_builder.getInt32(*constVal);
     }
+    auto linkage = llvm::GlobalValue::LinkageTypes::InternalLinkage;
+    if (!m_exportedModules.empty() || m_linksInterfaces) {
+        // A module object and the programs that import it define the globals of the same other modules, like the
+        // functions that use them, and they are merged by name into one
+        linkage = llvm::GlobalValue::LinkageTypes::LinkOnceODRLinkage;
+        if (!initializer) initializer = llvm::Constant::getNullValue(generate_type(*stmt.type));
+    }
+    if (m_ownedModule) {
+        // Shared between the llvm modules, only the owner defines it
+        linkage = llvm::GlobalValue::LinkageTypes::ExternalLinkage;
+        if (!m_emitBodies) initializer = nullptr;
+    }
+    if (m_exportedModules.contains(m_currentModule)) {
+        linkage = llvm::GlobalValue::LinkageTypes::ExternalLinkage;
+    }
+    if (m_currentModule && !m_currentModule->interfaceObject.empty()) {
+        // Defined by the object of the module
+        linkage = llvm::GlobalValue::LinkageTypes::ExternalLinkage;
+        initializer = nullptr;
+    }
     auto globalVar =
-        new llvm::GlobalVariable(generate_type(*stmt.type), !stmt.isMutable,
-                                 llvm::GlobalValue::LinkageTypes::InternalLinkage, initializer, stmt.name());
+        new llvm::GlobalVariable(generate_type(*stmt.type), !stmt.isMutable, linkage, initializer, stmt.name());
     m_module->insertGlobalVariable(globalVar);
     m_declarations[&stmt] = globalVar;
 }
@@ -673,8 +673,8 @@ llvm::Value *Codegen::generate_error_in_place_expr(const ResolvedErrorInPlaceExp
         return global;
     } else {
         llvm::Constant *stringConst = llvm::ConstantDataArray::getString(*m_context, errorInPlaceExpr.identifier, true);
-        return new llvm::GlobalVariable(*m_module, stringConst->getType(), true,
-                                        llvm::GlobalVariable::LinkageTypes::PrivateLinkage, stringConst, errName);
+        return new llvm::GlobalVariable(*m_module, stringConst->getType(), true, error_linkage(), stringConst,
+                                        errName);
     }
 }
 
@@ -1,15 +1,30 @@
 // #define DEBUG
 #include "driver/Driver.hpp"
 
+#include <fcntl.h>
+
 #include "Stats.hpp"
+#include "backend/Backend.hpp"
+#include "bench/Corpus.hpp"
+#include "bench/Lexer.hpp"
+#include "bench/Synthetic.hpp"
+#include "build/Build.hpp"
 #include "fmt/Formatter.hpp"
+#include "interface/Interface.hpp"
+#include "jit/JIT.hpp"
 #include "lsp/server.hpp"
+#include "server/Server.hpp"
 #include "test_runner/test_runner.hpp"
 
 namespace DMZ {
 
 ptr<Driver> Driver::driver_instance = nullptr;
 
+static bool is_within(const std::filesystem::path &path, const std::filesystem::path &directory) {
+    auto relative = path.lexically_relative(directory);
+    return !directory.empty() && !relative.empty() && *relative.begin() != "..";
+}
+
 void Driver::display_help() {
     println("Usage:");
     println("  dmz [options] <source_file>\n");
@@ -29,18 +44,43 @@ void Driver::display_help() {
     println("  -deps-dot-dump       print the resolved syntax tree with dependencies in dot format");
     println("  -cfg-dump            print the control flow graph");
     println("  -llvm-dump           print the llvm module");
+    println("  -emit-llvm-bc        write the llvm module as bitcode to <file>.bc (or -o <file>)");
     println("  -print-stats         print the time stats");
     println("  -module              compile a module to .o file");
     println("  -g                   generate debug symbols");
-    println("  -run                 runs the program with lli (Just In Time)");
-    println("  -test                runs the test with lli (Just In Time)");
+    println("  -run                 runs the program in-process (Just In Time)");
+    println("  -test                runs the test in-process (Just In Time)");
     println("  -test-compiler [dir] runs the compiler tests in [dir] (default: ./test)");
+    println("  -test-filter <text>  runs only the tests (or test files) whose name contains <text>");
     println("  -fmt                 format the dmz source file");
     println("  -quiet               suppress output for successful tests");
+    println("  -force               run the tests that passed with the same inputs (in the cache dir) again");
+    println("  -j <n>               number of parallel jobs (0: all cores, default: 1)");
+    println("  -cache               reuse the programs and imported modules that did not change (in .dmz-cache)");
+    println("  -cache-dir <dir>     like -cache but with the cache in <dir>");
+    println("  -build-std           compile the standard library once into the cache, used with -cache");
+    println("  -ftime-trace[=file]  write a chrome trace of the compilation (default: <source>.trace.json)");
+    println("  -ftime-report-decls[=n] print the n declarations and generics that took most time (default: 20)");
+    println("  -stats-json <file>   write the stats, counters and peak memory as json to <file>");
+    println("  -bench-synthetic [shape] time the passes over generated programs of growing size");
+    println("                       (shape: functions=64,depth=2,generics=4,imports=2,chain=4,steps=4,runs=3)");
+    println("  -bench-compiler <dir> compile every file of <dir> in-process and report the median time of every phase");
+    println("  -bench-lexer <path>  lex a file or every file of a directory in memory and report the tokens per second");
+    println("  -bench-runs <n>      compilations of every file with -bench-compiler or -bench-lexer (default: 5)");
+    println("  -bench-save <file>   write the -bench-compiler results as json to <file>");
+    println("  -bench-baseline <file> compare the -bench-compiler results with the ones saved in <file>");
+    println("  -bench-threshold <n> percentage of growth of a median reported as a regression (default: 10)");
+    println("  -bench               runs the benchmarks in-process (Just In Time) and prints their times as json");
+    println("  -build <dir>         build the targets of <dir>/dmz.build in parallel (-j) into <dir>/build (or -o)");
+    println("  -serve               keep the imported modules parsed in a compile server");
+    println("  -client              send the compilation to the compile server");
+    println("  -socket <path>       socket of the compile server");
+    println("                       (default: $XDG_RUNTIME_DIR/dmz.sock, or /tmp/dmz-<uid>/dmz.sock)");
 }
 
 CompilerOptions CompilerOptions::parse_arguments(int argc, char **argv) {
     CompilerOptions options;
+    options.arguments.assign(argv + 1, argv + argc);
 
     int idx = 1;
     while (idx < argc) {
@@ -81,6 +121,8 @@ CompilerOptions CompilerOptions::parse_arguments(int argc, char **argv) {
                 options.depsDotDump = true;
             } else if (arg == "-llvm-dump") {
                 options.llvmDump = true;
+            } else if (arg == "-emit-llvm-bc") {
+                options.emitLLVMBC = true;
             } else if (arg == "-asm-dump") {
                 options.asmDump = true;
             } else if (arg == "-cfg-dump") {
@@ -91,6 +133,8 @@ CompilerOptions CompilerOptions::parse_arguments(int argc, char **argv) {
                 options.debugSymbols = true;
             } else if (arg == "-test") {
                 options.test = true;
+            } else if (arg == "-bench") {
+                options.bench = true;
             } else if (arg == "-test-compiler") {
                 options.testCompiler = true;
                 if (++idx < argc) {
@@ -104,10 +148,66 @@ CompilerOptions CompilerOptions::parse_arguments(int argc, char **argv) {
                 if (options.source.empty()) {
                     options.source = "./test";
                 }
+            } else if (arg == "-test-filter") {
+                if (++idx < argc) {
+                    options.testFilter = argv[idx];
+                }
+            } else if (arg == "-bench-synthetic") {
+                options.benchSynthetic = true;
+                if (++idx < argc) {
+                    std::string_view nextArg = argv[idx];
+                    if (nextArg[0] != '-') {
+                        options.benchShape = nextArg;
+                    } else {
+                        --idx;  // Put it back, it's another option
+                    }
+                }
+            } else if (arg == "-bench-compiler") {
+                options.benchCompiler = true;
+                if (++idx < argc) options.source = argv[idx];
+            } else if (arg == "-bench-lexer") {
+                options.benchLexer = true;
+                if (++idx < argc) options.source = argv[idx];
+            } else if (arg == "-bench-runs") {
+                if (++idx < argc) {
+                    options.benchRuns = std::max(std::stoi(argv[idx]), 1);
+                }
+            } else if (arg == "-bench-save") {
+                if (++idx < argc) {
+                    options.benchSave = argv[idx];
+                }
+            } else if (arg == "-bench-baseline") {
+                if (++idx < argc) {
+                    options.benchBaseline = argv[idx];
+                }
+            } else if (arg == "-bench-threshold") {
+                if (++idx < argc) {
+                    options.benchThreshold = std::stod(argv[idx]);
+                }
             } else if (arg == "-j") {
                 if (++idx < argc) {
                     options.parallelJobs = std::stoi(argv[idx]);
                 }
+            } else if (arg == "-cache") {
+                options.cache = true;
+            } else if (arg == "-cache-dir") {
+                options.cache = true;
+                if (++idx < argc) {
+                    options.cacheDir = argv[idx];
+                }
+            } else if (arg == "-build") {
+                options.build = true;
+                if (++idx < argc) options.source = argv[idx];
+            } else if (arg == "-build-std") {
+                options.buildStd = true;
+            } else if (arg == "-serve") {
+                options.serve = true;
+            } else if (arg == "-client") {
+                options.client = true;
+            } else if (arg == "-socket") {
+                if (++idx < argc) {
+                    options.socketPath = argv[idx];
+                }
             } else if (arg == "-fmt-dump") {
                 options.fmtDump = true;
             } else if (arg == "-fmt") {
@@ -116,10 +216,24 @@ CompilerOptions CompilerOptions::parse_arguments(int argc, char **argv) {
                 options.isModule = true;
             } else if (arg == "-print-stats") {
                 options.printStats = true;
+            } else if (arg == "-stats-json") {
+                if (++idx < argc) {
+                    options.statsJson = argv[idx];
+                }
+            } else if (arg == "-ftime-trace") {
+                options.timeTrace = "-";
+            } else if (arg.starts_with("-ftime-trace=")) {
+                options.timeTrace = arg.substr(13);
+            } else if (arg == "-ftime-report-decls") {
+                options.timeReportDecls = 20;
+            } else if (arg.starts_with("-ftime-report-decls=")) {
+                options.timeReportDecls = std::max(std::stoi(std::string(arg.substr(20))), 1);
             } else if (arg == "-lsp" || arg == "--lsp") {
                 options.lsp = true;
             } else if (arg == "-quiet") {
                 options.quiet = true;
+            } else if (arg == "-force") {
+                options.force = true;
             } else {
                 error("unexpected option '" + std::string(arg) + '\'');
             }
@@ -131,6 +245,19 @@ CompilerOptions CompilerOptions::parse_arguments(int argc, char **argv) {
     return options;
 }
 
+void Driver::reset(CompilerOptions options) {
+    debug_func("");
+    m_workers.resize(options.parallelJobs);
+    m_options = std::move(options);
+    modules.clear();
+    m_haveError = false;
+    m_haveNormalExit = false;
+    m_importing = false;
+    m_failedImports.clear();
+    m_exportedModules.clear();
+    m_cachedObjects.clear();
+}
+
 bool Driver::need_exit() {
     if (m_haveError || m_haveNormalExit) return debug_ret(true);
     return debug_ret(false);
@@ -171,8 +298,16 @@ void Driver::check_sources_pass(std::filesystem::path &source) {
     }
 }
 
+ptr<Lexer> Driver::source_lexer(const std::filesystem::path &source) {
+    auto it = lexed_sources.find(source);
+    if (it == lexed_sources.end()) return makePtr<Lexer>(source.string());
+    // Every source is parsed once, the tokens are moved to its lexer
+    auto &&[tokens, buffer] = it->second;
+    return makePtr<Lexer>(source.string(), std::move(tokens), std::move(buffer), false);
+}
+
 ptr<Lexer> Driver::lexer_pass(std::filesystem::path &source) {
-    ptr<Lexer> lexer = makePtr<Lexer>(source.c_str());
+    ptr<Lexer> lexer = source_lexer(source);
 
     if (m_options.lexerDump) {
         Token tok;
@@ -249,6 +384,8 @@ std::pair<std::string, std::filesystem::path> Driver::register_import(SourceLoca
                                                                       std::string_view imported) {
     debug_func("source: '" << source << "' imported '" << imported << "'");
     auto &d = instance();
+    // Imports are registered concurrently by the parser tasks of import_pass
+    std::unique_lock lock(d.m_importsMutex);
 
 #ifdef DEBUG
     debug_msg("Registed modules " << d.imported_modules.size());
@@ -355,6 +492,8 @@ std::pair<std::string, std::filesystem::path> Driver::register_import(SourceLoca
     debug_msg("module_path " << module_path);
     debug_msg("identifier " << identifier);
 
+    d.module_imports[source].emplace(module_path);
+
     debug_msg("Search: " << module_path);
     if (d.imported_modules.find(module_path) != d.imported_modules.end()) {
         debug_msg("find not reimport: " << module_path);
@@ -363,46 +502,95 @@ std::pair<std::string, std::filesystem::path> Driver::register_import(SourceLoca
 
     debug_msg("Register module: '" << module_path << "'");
     d.imported_modules.emplace(module_path, nullptr);
+    if (d.m_importing) {
+        lock.unlock();
+        d.schedule_import(module_path);
+    }
     return {identifier, module_path};
 }
 
+void Driver::schedule_import(const std::filesystem::path &module_path) {
+    debug_func(module_path);
+    m_workers.submit([this, module_path] { parse_import(module_path); });
+}
+
+void Driver::parse_import(const std::filesystem::path &module_path) {
+    debug_func(module_path);
+    dmz_profile_scope_args("Parse module", module_path);
+    if (!std::filesystem::exists(module_path)) {
+        std::unique_lock lock(m_importsMutex);
+        m_failedImports.emplace_back(module_path);
+        return;
+    }
+
+    {
+        std::unique_lock lock(m_importsMutex);
+        module_imports.erase(module_path);
+    }
+
+    // A module built with -module is read from its interface, its function bodies are linked from the object
+    std::optional<ModuleInterface> interface;
+    if (!m_options.buildStd) {
+        auto path = interface_path(module_path);
+        interface = ModuleInterface::read(module_path, path);
+        if (interface && m_options.cache && Stats::enabled() &&
+            is_within(std::filesystem::absolute(path), std::filesystem::absolute(m_options.cacheDir))) {
+            Stats::instance().add_count(CounterType::CacheHits, 1);
+        }
+        // A module built with -module next to its source is used when it is not in the cache
+        if (!interface && m_options.cache) {
+            interface = ModuleInterface::read(module_path, ModuleInterface::path_for(module_path));
+        }
+    }
+    ptr<Lexer> l = interface ? makePtr<Lexer>(module_path.string(), std::move(interface->tokens),
+                                              std::move(interface->buffer), true)
+                             : source_lexer(module_path);
+    Parser p(*l);
+    auto [parse_ast, success] = p.parse_source_file();
+    if (parse_ast && interface) {
+        parse_ast->interfaceObject = std::move(interface->object);
+        parse_ast->interfaceSymbol = std::move(interface->symbolName);
+    }
+
+    std::unique_lock lock(m_importsMutex);
+    // Even if parsing failed, we might have an incomplete AST that we want to keep
+    if (!parse_ast) {
+        m_failedImports.emplace_back(module_path);
+        return;
+    }
+    imported_modules[module_path] = std::move(parse_ast);
+}
+
 void Driver::import_pass(ptr<ModuleDecl> &ast) {
     debug_func("");
-    auto all_imported = [&]() -> bool {
-        for (auto &&[k, v] : imported_modules) {
-            if (!v) return false;
-        }
-        return true;
-    };
+    ScopedTimer(StatType::Import);
+    // Modules kept from a previous compilation that this program no longer imports are not parsed again
+    if (pruneImports) prune_imports();
 
-    while (!all_imported()) {
-        std::vector<std::filesystem::path> to_remove;
+    std::vector<std::filesystem::path> pending;
+    {
+        std::unique_lock lock(m_importsMutex);
         for (auto &&[k, v] : imported_modules) {
-            if (!v) {
-                if (!std::filesystem::exists(k)) {
-                    to_remove.emplace_back(k);
-                    continue;
-                }
-                Lexer l(k.string());
-                Parser p(l);
-                auto [parse_ast, success] = p.parse_source_file();
-                if (!success) {
-                    // Even if parsing failed, we might have an incomplete AST that we want to keep
-                    if (!parse_ast) {
-                        to_remove.emplace_back(k);
-                        continue;
-                    }
-                }
-                v = std::move(parse_ast);
-            }
+            if (!v) pending.emplace_back(k);
         }
-        if (to_remove.size() != 0) {
-            m_haveError = true;
-            for (auto &&k : to_remove) {
-                imported_modules.erase(k);
-            }
+        m_failedImports.clear();
+        m_importing = true;
+    }
+
+    // Every module is lexed and parsed in its own task, the imports it registers are scheduled as they are found
+    for (auto &&k : pending) {
+        schedule_import(k);
+    }
+    m_workers.wait();
+    m_importing = false;
+
+    if (m_failedImports.size() != 0) {
+        m_haveError = true;
+        for (auto &&k : m_failedImports) {
+            imported_modules.erase(k);
         }
     }
+    if (pruneImports) prune_imports();
 
     if (m_options.importDump) {
         ast->dump();
@@ -415,17 +603,71 @@ void Driver::import_pass(ptr<ModuleDecl> &ast) {
     return;
 }
 
+void Driver::prune_imports() {
+    debug_func("");
+    std::unordered_set<std::filesystem::path> reachable;
+    std::vector<std::filesystem::path> pending = {m_options.source};
+    while (!pending.empty()) {
+        auto it = module_imports.find(pending.back());
+        pending.pop_back();
+        if (it == module_imports.end()) continue;
+        for (auto &&imported : it->second) {
+            if (reachable.emplace(imported).second) pending.emplace_back(imported);
+        }
+    }
+    std::erase_if(imported_modules, [&](auto &module) { return !reachable.contains(module.first); });
+}
+
+std::vector<std::filesystem::path> Driver::transitive_imports(const std::filesystem::path &source) {
+    std::vector<std::filesystem::path> imports;
+    std::unordered_set<std::filesystem::path> seen = {source};
+    std::vector<std::filesystem::path> pending = {source};
+    while (!pending.empty()) {
+        auto it = module_imports.find(pending.back());
+        pending.pop_back();
+        if (it == module_imports.end()) continue;
+        for (auto &&imported : it->second) {
+            if (!seen.emplace(imported).second) continue;
+            imports.emplace_back(imported);
+            pending.emplace_back(imported);
+        }
+    }
+    std::sort(imports.begin(), imports.end());
+    return imports;
+}
+
+std::vector<std::filesystem::path> Driver::interface_objects() {
+    std::vector<std::filesystem::path> objects;
+    for (auto &&[k, v] : imported_modules) {
+        if (v && !v->interfaceObject.empty()) objects.emplace_back(v->interfaceObject);
+    }
+    objects.insert(objects.end(), m_cachedObjects.begin(), m_cachedObjects.end());
+    return objects;
+}
+
 std::vector<ptr<ResolvedModuleDecl>> Driver::semantic_pass(ptr<ModuleDecl> ast) {
     debug_func("");
     ScopedTimer(StatType::Semantic);
+    uint64_t resolvedDecls = t_resolvedDecls;
+    defer([&] {
+        if (Stats::enabled()) Stats::instance().add_count(CounterType::ResolvedDecls, t_resolvedDecls - resolvedDecls);
+    });
     std::vector<ptr<ResolvedModuleDecl>> resolvedTree;
     Sema sema(std::move(ast));
-    bool needMain = !m_options.isModule && !m_options.test;
+    bool needMain = !m_options.isModule && !m_options.test && !m_options.bench;
     resolvedTree = sema.resolve_ast_decl(m_options.source, needMain);
     if (resolvedTree.empty()) m_haveError = true;
 
     if (!m_haveError && !sema.resolve_ast_body(resolvedTree)) m_haveError = true;
-    if (!m_haveError && !m_options.noRemoveUnused) sema.remove_unused(resolvedTree, m_options.test);
+    if (!m_haveError) {
+        // Everything declared by a module build is kept, the programs that import it link it from the object
+        for (auto &&moduleDecl : resolvedTree) {
+            if (!is_exported(*moduleDecl)) continue;
+            sema.export_module(*moduleDecl);
+            m_exportedModules.emplace_back(moduleDecl->module_path, moduleDecl->name());
+        }
+    }
+    if (!m_haveError && !m_options.noRemoveUnused) sema.remove_unused(resolvedTree, m_options.test, m_options.bench);
 
     if (m_options.depsDump || m_options.depsDotDump) {
         if (!m_haveError) {
@@ -453,7 +695,7 @@ std::vector<ptr<ResolvedModuleDecl>> Driver::semantic_pass(ptr<ModuleDecl> ast)
                 if (const auto *md = dynamic_cast<const ResolvedModuleDecl *>(decl.get())) {
                     for (auto &&func : md->declarations) {
                         const auto *fn = dynamic_cast<const ResolvedFunctionDecl *>(func.get());
-                        if (!fn) continue;
+                        if (!fn || !fn->body) continue;
 
                         std::cerr << fn->identifier << ':' << '\n';
                         CFGBuilder().build(*fn->body).dump();
@@ -468,11 +710,37 @@ std::vector<ptr<ResolvedModuleDecl>> Driver::semantic_pass(ptr<ModuleDecl> ast)
     return resolvedTree;
 }
 
+bool Driver::is_exported(const ResolvedModuleDecl &moduleDecl) {
+    if (!m_options.isModule || m_options.test || m_options.bench) return false;
+    if (m_options.buildStd) {
+        // The standard library object holds every module of the library
+        return is_within(moduleDecl.module_path, m_options.source.parent_path());
+    }
+    return moduleDecl.module_path == m_options.source;
+}
+
 std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>> Driver::codegen_pass(
     std::vector<ptr<ResolvedModuleDecl>> resolvedTree) {
     debug_func("");
-    Codegen codegen(std::move(resolvedTree), m_options.source.c_str(), m_options.debugSymbols);
-    std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>> module = codegen.generate_ir(m_options.test);
+    std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>> module;
+    if (m_workers.size() > 1 && resolvedTree.size() > 1) {
+        module = module_codegen_pass(std::move(resolvedTree));
+        if (!module.second) {
+            m_haveError = true;
+            return {};
+        }
+    } else {
+        const ResolvedModuleDecl *exported = nullptr;
+        for (auto &&moduleDecl : resolvedTree) {
+            if (is_exported(*moduleDecl)) exported = moduleDecl.get();
+        }
+        Codegen codegen(std::move(resolvedTree), m_options.source.c_str(), m_options.debugSymbols);
+        if (exported) codegen.export_module(*exported);
+        module = codegen.generate_ir(m_options.test, m_options.bench);
+    }
+    if (module.second && Stats::enabled()) {
+        Stats::instance().add_count(CounterType::LLVMInstructions, module.second->getInstructionCount());
+    }
 
     if (m_options.llvmDump) {
         module.second->dump();
@@ -483,7 +751,87 @@ std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>> Driver::codegen_pass(
     return module;
 }
 
-int Driver::jit_pass(ptr<llvm::Module> &module) {
+std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>> Driver::module_codegen_pass(
+    std::vector<ptr<ResolvedModuleDecl>> resolvedTree) {
+    debug_func("");
+    ScopedTimer(StatType::Codegen);
+    auto tree = move_vector_ptr<ResolvedModuleDecl, ResolvedDecl>(resolvedTree);
+
+    // Every module is generated in its own context, the rest of the program is only declared in it. The first one is
+    // the destination of the link, the others are written as bitcode on their thread so only parsing them back into
+    // its context is serial.
+    std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>> destination;
+    std::vector<std::pair<std::string, std::string>> bitcodes(tree.size());
+    const ResolvedModuleDecl *exported = nullptr;
+    for (auto &&decl : tree) {
+        auto *moduleDecl = static_cast<const ResolvedModuleDecl *>(decl.get());
+        if (is_exported(*moduleDecl)) exported = moduleDecl;
+    }
+    auto first = std::find_if(tree.begin(), tree.end(), [](auto &decl) { return decl->is_needed(); }) - tree.begin();
+    {
+        ThreadPool::TaskGroup group(m_workers);
+        for (size_t i = 0; i < tree.size(); i++) {
+            if (!tree[i]->is_needed()) continue;
+            auto &moduleDecl = *static_cast<const ResolvedModuleDecl *>(tree[i].get());
+            group.submit([this, &tree, &destination, &bitcodes, &moduleDecl, exported, first, i] {
+                Codegen codegen(tree, moduleDecl, m_options.source.c_str(), m_options.debugSymbols);
+                if (exported) codegen.export_module(*exported);
+                auto module = codegen.generate_ir(m_options.test, m_options.bench);
+                Linker::remove_unused_declarations(*module.second);
+                if (static_cast<ptrdiff_t>(i) == first) {
+                    destination = std::move(module);
+                    return;
+                }
+                bitcodes[i] = {module.second->getModuleIdentifier(), Linker::write_bitcode(*module.second)};
+            });
+        }
+        group.wait();
+    }
+    if (!destination.second) return {};
+    std::erase_if(bitcodes, [](auto &bitcode) { return bitcode.second.empty(); });
+
+    ScopedTimer(StatType::Codegen_Link);
+    std::vector<std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>>> modules;
+    modules.emplace_back(std::move(destination));
+    // Every definition is needed, the unused ones were already removed by sema
+    Linker linker(std::move(modules), std::move(bitcodes), llvm::Linker::Flags::None);
+    return linker.link_modules();
+}
+
+int Driver::jit_pass(std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>> &module) {
+    debug_func("");
+    JIT jit(m_options.optimizationLevel);
+    if (jit.create()) {
+        return jit.run(std::move(module.first), std::move(module.second), interface_objects());
+    }
+
+    // Fallback to an external lli when the host cannot be targeted in-process
+    return lli_pass(module.second);
+}
+
+int Driver::lli_pass(ptr<llvm::Module> &module) {
+    debug_func("");
+    ScopedTimer(StatType::Run);
+
+    std::vector<const char *> args;
+    args.emplace_back("lli");
+    if (!m_options.optimizationLevel.empty()) {
+        args.emplace_back(m_options.optimizationLevel.c_str());
+    } else {
+        args.emplace_back("-O0");
+    }
+    std::vector<std::string> objects;
+    for (auto &&object : interface_objects()) {
+        objects.emplace_back("--extra-object=" + object.string());
+    }
+    for (auto &&object : objects) {
+        args.emplace_back(object.c_str());
+    }
+    args.emplace_back(nullptr);
+    return pipe_module_pass(args, module);
+}
+
+int Driver::pipe_module_pass(const std::vector<const char *> &args, ptr<llvm::Module> &module) {
     debug_func("");
     int pipefd[2];
     if (pipe(pipefd) == -1) {
@@ -491,8 +839,6 @@ int Driver::jit_pass(ptr<llvm::Module> &module) {
         return 1;
     }
 
-    ScopedTimer(StatType::Run);
-
     pid_t pid = fork();
 
     int status;
@@ -506,28 +852,17 @@ int Driver::jit_pass(ptr<llvm::Module> &module) {
         dup2(pipefd[0], STDIN_FILENO);
         close(pipefd[0]);
 
-        const char *cmd = nullptr;
-        std::vector<const char *> args;
-
-        cmd = "lli";
-        args.emplace_back("lli");
-        if (!m_options.optimizationLevel.empty()) {
-            args.emplace_back(m_options.optimizationLevel.c_str());
-        } else {
-            args.emplace_back("-O0");
-        }
-        args.emplace_back(nullptr);
-
-        execvp(cmd, const_cast<char *const *>(args.data()));
+        execvp(args[0], const_cast<char *const *>(args.data()));
         perror("execvp");
         exit(EXIT_FAILURE);
     } else {
         // parent
         close(pipefd[0]);
 
+        // Bitcode is much cheaper to write and to parse back than the textual IR
         llvm::raw_fd_ostream pipe_stream(pipefd[1], false);
-
-        module->print(pipe_stream, nullptr);
+        llvm::WriteBitcodeToFile(*module, pipe_stream);
+        pipe_stream.flush();
 
         close(pipefd[1]);
 
@@ -535,15 +870,62 @@ int Driver::jit_pass(ptr<llvm::Module> &module) {
         return WEXITSTATUS(status);
     }
 }
+
+int Driver::bitcode_pass(ptr<llvm::Module> &module) {
+    debug_func("");
+    ScopedTimer(StatType::Compile);
+
+    Backend backend(m_options.optimizationLevel);
+    if (backend.create()) {
+        backend.optimize_module(*module);
+    }
+
+    std::filesystem::path output = m_options.output;
+    if (output.empty()) output = m_options.source.stem().string() + ".bc";
+
+    std::error_code EC;
+    llvm::raw_fd_ostream out(output.string(), EC, llvm::sys::fs::OF_None);
+    if (EC) {
+        error("could not open '" + output.string() + "': " + EC.message());
+    }
+    llvm::WriteBitcodeToFile(*module, out);
+    return EXIT_SUCCESS;
+}
+
 int Driver::generate_exec_pass(ptr<llvm::Module> &module) {
     debug_func("");
-    int pipefd[2];
-    if (pipe(pipefd) == -1) {
-        perror("pipe");
-        return 1;
+    Backend backend(m_options.optimizationLevel);
+    if (!backend.create()) {
+        // Without a native target let clang do the whole backend work
+        return clang_pass(module, false);
     }
 
     ScopedTimer(StatType::Compile);
+    backend.optimize_module(*module);
+
+    if (m_options.isModule) {
+        std::filesystem::path output = m_options.output;
+        if (output.empty()) output = m_options.source.stem().string() + ".o";
+        return backend.emit_file(*module, output, llvm::CodeGenFileType::ObjectFile) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    std::string objectPath = (std::filesystem::temp_directory_path() / "dmz-XXXXXX.o").string();
+    int fd = mkstemps(objectPath.data(), 2);
+    if (fd == -1) {
+        perror("mkstemps");
+        return EXIT_FAILURE;
+    }
+    close(fd);
+    defer([&] { std::filesystem::remove(objectPath); });
+
+    if (!backend.emit_file(*module, objectPath, llvm::CodeGenFileType::ObjectFile)) return EXIT_FAILURE;
+    return link_pass(objectPath);
+}
+
+int Driver::link_pass(const std::filesystem::path &object) {
+    debug_func("");
+    ScopedTimer(StatType::Compile_Link);
+    auto objects = interface_objects();
 
     pid_t pid = fork();
 
@@ -553,52 +935,26 @@ int Driver::generate_exec_pass(ptr<llvm::Module> &module) {
         return 1;
     } else if (pid == 0) {
         // child
-        close(pipefd[1]);
-
-        dup2(pipefd[0], STDIN_FILENO);
-        close(pipefd[0]);
-
         const char *cmd = nullptr;
         std::vector<const char *> args;
 
         cmd = "clang";
         args.emplace_back("clang");
-        if (!m_options.optimizationLevel.empty()) {
-            args.emplace_back(m_options.optimizationLevel.c_str());
-        } else {
-            args.emplace_back("-O0");
-        }
-        if (m_options.debugSymbols) {
-            args.emplace_back("-g");
-        }
-        args.emplace_back("-x");
-        args.emplace_back("ir");
-        args.emplace_back("-");
-        if (m_options.isModule) {
-            args.emplace_back("-c");
+        args.emplace_back(object.c_str());
+        for (auto &&interfaceObject : objects) {
+            args.emplace_back(interfaceObject.c_str());
         }
         if (!m_options.output.empty()) {
             args.emplace_back("-o");
             args.emplace_back(m_options.output.c_str());
         }
         args.emplace_back(nullptr);
-        // for (auto &&arg : args) {
-        //     println(arg);
-        // }
 
         execvp(cmd, const_cast<char *const *>(args.data()));
         perror("execvp");
         exit(EXIT_FAILURE);
     } else {
         // parent
-        close(pipefd[0]);
-
-        llvm::raw_fd_ostream pipe_stream(pipefd[1], false);
-
-        module->print(pipe_stream, nullptr);
-
-        close(pipefd[1]);
-
         waitpid(pid, &status, 0);
         return WEXITSTATUS(status);
     }
@@ -606,69 +962,264 @@ int Driver::generate_exec_pass(ptr<llvm::Module> &module) {
 
 int Driver::asm_pass(ptr<llvm::Module> &module) {
     debug_func("");
-    int pipefd[2];
-    if (pipe(pipefd) == -1) {
-        perror("pipe");
-        return 1;
+    Backend backend("-O0");
+    if (!backend.create()) {
+        return clang_pass(module, true);
     }
 
-    pid_t pid = fork();
-
-    int status;
-    if (pid == -1) {
-        perror("fork");
-        return 1;
-    } else if (pid == 0) {
-        // child
-        close(pipefd[1]);
-
-        dup2(pipefd[0], STDIN_FILENO);
-        close(pipefd[0]);
+    backend.optimize_module(*module);
+    return backend.emit_file(*module, llvm::outs(), llvm::CodeGenFileType::AssemblyFile) ? EXIT_SUCCESS
+                                                                                          : EXIT_FAILURE;
+}
 
-        const char *cmd = nullptr;
-        std::vector<const char *> args;
+int Driver::clang_pass(ptr<llvm::Module> &module, bool assembly) {
+    debug_func("");
+    ScopedTimer(StatType::Compile);
 
-        cmd = "clang";
-        args.emplace_back("clang");
+    std::vector<const char *> args;
+    args.emplace_back("clang");
+    if (assembly) {
         args.emplace_back("-O0");
         args.emplace_back("-g");
+    } else {
+        if (!m_options.optimizationLevel.empty()) {
+            args.emplace_back(m_options.optimizationLevel.c_str());
+        } else {
+            args.emplace_back("-O0");
+        }
+        if (m_options.debugSymbols) {
+            args.emplace_back("-g");
+        }
+    }
+    args.emplace_back("-x");
+    args.emplace_back("ir");
+    args.emplace_back("-");
+    auto objects = interface_objects();
+    if (!assembly && !m_options.isModule && !objects.empty()) {
         args.emplace_back("-x");
-        args.emplace_back("ir");
-        args.emplace_back("-");
-        args.emplace_back("-S");
-        if (m_options.isModule) {
-            args.emplace_back("-c");
+        args.emplace_back("none");
+        for (auto &&object : objects) {
+            args.emplace_back(object.c_str());
         }
+    }
+    if (assembly) {
+        args.emplace_back("-S");
+    }
+    if (m_options.isModule) {
+        args.emplace_back("-c");
+    }
+    if (assembly) {
         args.emplace_back("-o");
         args.emplace_back("-");
-        args.emplace_back(nullptr);
+    } else if (!m_options.output.empty()) {
+        args.emplace_back("-o");
+        args.emplace_back(m_options.output.c_str());
+    }
+    args.emplace_back(nullptr);
+    return pipe_module_pass(args, module);
+}
 
-        execvp(cmd, const_cast<char *const *>(args.data()));
-        perror("execvp");
-        exit(EXIT_FAILURE);
+int Driver::output_pass(std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>> &module) {
+    debug_func("");
+    if (m_options.asmDump) {
+        return asm_pass(module.second);
+    }
+
+    if (m_options.emitLLVMBC) {
+        return bitcode_pass(module.second);
+    }
+
+    if (m_options.run) {
+        return jit_pass(module);
     } else {
-        // parent
-        close(pipefd[0]);
+        return generate_exec_pass(module.second);
+    }
+}
 
-        llvm::raw_fd_ostream pipe_stream(pipefd[1], false);
+int Driver::interface_pass(const std::vector<std::filesystem::path> &cachedModules) {
+    debug_func("");
+    std::filesystem::path object = m_options.output;
+    if (object.empty()) object = m_options.source.stem().string() + ".o";
+    // Without the resolved tree (cached module) the module has the default name, its file stem
+    if (m_exportedModules.empty()) m_exportedModules.emplace_back(m_options.source, m_options.source.stem().string());
+
+    for (auto &&[source, symbolName] : m_exportedModules) {
+        auto path = interface_path(source);
+        // A module loaded from the cache was not parsed, every module of its cache entry is taken as an import
+        auto imports = cachedModules.empty() ? transitive_imports(source) : cachedModules;
+        if (!ModuleInterface::write(source, path, object, symbolName, imports)) {
+            error("cannot write the interface '" + path.string() + "'");
+        }
+    }
+    return EXIT_SUCCESS;
+}
 
-        module->print(pipe_stream, nullptr);
+std::filesystem::path Driver::interface_path(const std::filesystem::path &module_path) {
+    // The interfaces of the standard library are in the cache with its object, see build_std_pass
+    if ((m_options.cache || m_options.buildStd) && !m_options.test && !m_options.bench) {
+        std::filesystem::path stdSource;
+        {
+            std::unique_lock lock(m_importsMutex);
+            if (auto it = m_options.imports.find("std"); it != m_options.imports.end()) stdSource = it->second;
+        }
+        auto stdDirectory = stdSource.parent_path();
+        if (is_within(module_path, stdDirectory)) {
+            auto path =
+                ModuleInterface::path_for(m_options.cacheDir / "std" / module_path.lexically_relative(stdDirectory));
+            if (m_options.buildStd || std::filesystem::exists(path)) return path;
+        }
+        // Every other module is cached on its own, see module_cache_pass
+        if (m_options.cache) return ModuleInterface::path_for(module_cache_path(module_path));
+    }
+    return ModuleInterface::path_for(module_path);
+}
 
-        close(pipefd[1]);
+void Driver::build_std_pass() {
+    debug_func("");
+    std::filesystem::path stdSource;
+    if (auto it = m_options.imports.find("std"); it != m_options.imports.end()) {
+        stdSource = it->second;
+    } else if (std::filesystem::exists("std/std.dmz")) {
+        stdSource = std::filesystem::canonical("std/std.dmz");
+    } else {
+        error("standard library not found, use -I std <path>");
+    }
 
-        waitpid(pid, &status, 0);
-        return WEXITSTATUS(status);
+    // Every module of the library is compiled into one object, the programs only specialize its generics
+    std::filesystem::path directory = m_options.cacheDir / "std";
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) error("cannot create '" + directory.string() + "': " + ec.message());
+
+    m_options.imports["std"] = stdSource;
+    m_options.source = stdSource;
+    m_options.output = directory / "std.o";
+    m_options.isModule = true;
+}
+
+bool Driver::cacheable() {
+    if (!m_options.cache || m_options.buildStd || m_options.source == "-") return false;
+    // The dumps and the formatter need the intermediate results that the cache skips
+    return !(m_options.lexerDump || m_options.astDump || m_options.importDump || m_options.resDump ||
+             m_options.depsDump || m_options.depsDotDump || m_options.cfgDump || m_options.llvmDump ||
+             m_options.fmt || m_options.fmtDump);
+}
+
+std::string Driver::module_configuration() {
+    // The imports are not part of it, they can change while importing (std is found on the first import of it) and
+    // the interface of every module records the modules it imported
+    std::stringstream ss;
+    ss << llvm::sys::getDefaultTargetTriple() << ' ' << llvm::sys::getHostCPUName().str();
+    ss << ' ' << m_options.optimizationLevel << " g=" << m_options.debugSymbols;
+    return ss.str();
+}
+
+std::string Driver::cache_configuration() {
+    std::stringstream ss;
+    // The objects of the imported modules linked by the program depend on the module configuration
+    ss << module_configuration();
+    ss << " test=" << m_options.test << " bench=" << m_options.bench << " module=" << m_options.isModule
+       << " no-remove-unused=" << m_options.noRemoveUnused;
+    std::map<std::string, std::filesystem::path> imports(m_options.imports.begin(), m_options.imports.end());
+    for (auto &&[k, v] : imports) {
+        ss << " -I " << k << ' ' << v.string();
     }
+    return ss.str();
 }
 
-int Driver::ptrBitSize() {
-    static int ptrSize = -1;
-    if (ptrSize >= 0) {
-        return ptrSize;
+std::filesystem::path Driver::module_cache_path(const std::filesystem::path &module_path) {
+    return Cache::module_path(m_options.cacheDir, module_path, module_configuration());
+}
+
+void Driver::module_cache_pass(const std::vector<std::filesystem::path> &modules) {
+    debug_func("");
+    ScopedTimer(StatType::Cache);
+    std::error_code ec;
+    std::string compiler = std::filesystem::read_symlink("/proc/self/exe", ec).string();
+    if (ec) return;
+
+    // Every module is built by a child compiler with -module, like a module target of -build, into its object and the
+    // interface that the next programs read instead of the source
+    std::vector<std::string> arguments = {"-module", "-cache-dir", m_options.cacheDir.string(),
+                                          m_options.optimizationLevel};
+    if (m_options.debugSymbols) arguments.emplace_back("-g");
+    for (auto &&[k, v] : m_options.imports) {
+        arguments.insert(arguments.end(), {"-I", k, v.string()});
     }
-    llvm::LLVMContext context;
-    llvm::Module module("tmp", context);
-    ptrSize = module.getDataLayout().getPointerSizeInBits();
+
+    std::unordered_set<pid_t> running;
+    size_t maxJobs = m_options.parallelJobs <= 0 ? std::thread::hardware_concurrency() : m_options.parallelJobs;
+    size_t next = 0;
+    while (next < modules.size() || !running.empty()) {
+        for (; next < modules.size() && running.size() < maxJobs; next++) {
+            std::filesystem::path object = module_cache_path(modules[next]).replace_extension(".o");
+            std::filesystem::create_directories(object.parent_path(), ec);
+            std::vector<const char *> args = {compiler.c_str(), modules[next].c_str(), "-o", object.c_str()};
+            for (auto &&arg : arguments) {
+                args.emplace_back(arg.c_str());
+            }
+            args.emplace_back(nullptr);
+
+            pid_t pid = fork();
+            if (pid == -1) {
+                perror("fork");
+                next = modules.size();
+                break;
+            }
+            if (pid == 0) {
+                // The diagnostics of the module were already reported by this compilation
+                int devNull = open("/dev/null", O_WRONLY);
+                dup2(devNull, STDOUT_FILENO);
+                dup2(devNull, STDERR_FILENO);
+                execv(args[0], const_cast<char *const *>(args.data()));
+                _exit(EXIT_FAILURE);
+            }
+            running.emplace(pid);
+        }
+        if (running.empty()) break;
+
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid == -1) {
+            if (errno == EINTR) continue;
+            perror("waitpid");
+            break;
+        }
+        running.erase(pid);
+        // A module that cannot be built on its own is parsed from its source again by the next programs
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            debug_msg("cannot cache a module, child " << pid);
+        }
+    }
+}
+
+std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>> Driver::cache_load_pass(Cache &cache) {
+    debug_func("");
+    auto context = makePtr<llvm::LLVMContext>();
+    auto module = cache.load(*context);
+    if (!module) return {};
+    return {std::move(context), std::move(module)};
+}
+
+void Driver::cache_store_pass(Cache &cache, const llvm::Module &module) {
+    debug_func("");
+    std::vector<std::filesystem::path> modules;
+    modules.emplace_back(std::filesystem::canonical(m_options.source));
+    for (auto &&[k, v] : imported_modules) {
+        modules.emplace_back(k);
+    }
+    if (!cache.store(modules, interface_objects(), module)) {
+        debug_msg("cannot store the module in the cache " << m_options.cacheDir);
+    }
+}
+
+int Driver::ptrBitSize() {
+    // Initialized once, the codegen threads can ask for it at the same time
+    static const int ptrSize = [] {
+        llvm::LLVMContext context;
+        llvm::Module module("tmp", context);
+        return static_cast<int>(module.getDataLayout().getPointerSizeInBits());
+    }();
     return ptrSize;
 }
 
@@ -680,48 +1231,42 @@ int Driver::typeBitSize(const ResolvedType &type) {
 }
 
 int Driver::target_simd_size() {
-    static int simdSize = -1;
-    if (simdSize >= 0) {
-        return simdSize;
-    }
-
-    llvm::InitializeAllTargetInfos();
-    llvm::InitializeAllTargets();
-    llvm::InitializeAllTargetMCs();
-    std::string TripleStr = llvm::sys::getDefaultTargetTriple();
-    std::string Error;
-    const llvm::Target *Target = llvm::TargetRegistry::lookupTarget(TripleStr, Error);
-
-    // 3. Crear el TargetMachine (aquí es donde defines CPU y Features)
-    llvm::TargetOptions opt;
-    auto RM = std::optional<llvm::Reloc::Model>();
-    std::string CPU = llvm::sys::getHostCPUName().str();
-    std::string Features;
-    auto allFeatures = llvm::sys::getHostCPUFeatures();
-    for (auto &feature : allFeatures) {
-        if (feature.second) {
-            Features += "+" + feature.first().str() + ",";
-        }
-    }
-    llvm::TargetMachine *TM = Target->createTargetMachine(TripleStr, CPU, Features, opt, RM);
-    llvm::LLVMContext ctx;
-    llvm::Module mod("tmp", ctx);
-    llvm::FunctionType *FTy = llvm::FunctionType::get(llvm::Type::getVoidTy(ctx), false);
-    llvm::Function *TempF = llvm::Function::Create(FTy, llvm::Function::ExternalLinkage, "__temp_tti", &mod);
-    llvm::TargetTransformInfo TTI = TM->getTargetTransformInfo(*TempF);
-
-    simdSize = TTI.getRegisterBitWidth(llvm::TargetTransformInfo::RGK_FixedWidthVector);
-
-    debug_msg("El ancho de banda SIMD para '" << TripleStr << "' cpu: '" << CPU << "' features: '" << Features
-                                              << "' es: " << vectorSize << " bits");
+    // Initialized once, the codegen threads can ask for it at the same time
+    static const int simdSize = [] {
+        auto TM = Backend::create_target_machine("-O0");
+        if (!TM) dmz_unreachable("cannot create the target machine for the host");
+        llvm::LLVMContext ctx;
+        llvm::Module mod("tmp", ctx);
+        llvm::FunctionType *FTy = llvm::FunctionType::get(llvm::Type::getVoidTy(ctx), false);
+        llvm::Function *TempF = llvm::Function::Create(FTy, llvm::Function::ExternalLinkage, "__temp_tti", &mod);
+        llvm::TargetTransformInfo TTI = TM->getTargetTransformInfo(*TempF);
+
+        int size = TTI.getRegisterBitWidth(llvm::TargetTransformInfo::RGK_FixedWidthVector);
+
+        debug_msg("El ancho de banda SIMD para '" << TM->getTargetTriple().str() << "' cpu: '"
+                                                  << TM->getTargetCPU().str() << "' features: '"
+                                                  << TM->getTargetFeatureString().str() << "' es: " << size
+                                                  << " bits");
+        return size;
+    }();
     return simdSize;
 }
 
 int Driver::main() {
-    dmz_profile_begin_session("dmz_profiler.json");
+    if (!m_options.timeTrace.empty()) {
+        std::filesystem::path traceFile = m_options.timeTrace;
+        if (traceFile == "-") {
+            traceFile = m_options.source == "-" ? "dmz" : m_options.source.stem();
+            traceFile += ".trace.json";
+        }
+        dmz_profile_begin_session(traceFile.string());
+    }
+    if (Stats::enabled()) AllocationCounter::enabled = true;
     defer([&] {
         dmz_profile_end_session();
         if (m_options.printStats) Stats::instance().dump();
+        if (!m_options.statsJson.empty()) Stats::instance().dump_json(m_options.statsJson);
+        if (m_options.timeReportDecls > 0) Stats::instance().dump_decls(m_options.timeReportDecls);
     });
     ScopedTimer(StatType::Total);
 
@@ -736,6 +1281,38 @@ int Driver::main() {
         return EXIT_SUCCESS;
     }
 
+    if (m_options.serve) {
+        server::CompileServer server(m_options);
+        return server.run();
+    }
+
+    if (m_options.client) {
+        // Without a server the compilation is done by this process
+        if (auto ret = server::run_client(m_options)) return *ret;
+    }
+
+    if (m_options.build) {
+        build::ProjectBuild projectBuild(m_options);
+        return projectBuild.run();
+    }
+
+    if (m_options.benchSynthetic) {
+        bench::SyntheticBench syntheticBench(m_options);
+        return syntheticBench.run();
+    }
+
+    if (m_options.benchCompiler) {
+        bench::CorpusBench corpusBench(m_options);
+        return corpusBench.run();
+    }
+
+    if (m_options.benchLexer) {
+        bench::LexerBench lexerBench(m_options);
+        return lexerBench.run();
+    }
+
+    if (m_options.buildStd) build_std_pass();
+
     check_sources_pass(m_options.source);
     if (need_exit()) return exit_code();
 
@@ -743,9 +1320,35 @@ int Driver::main() {
         TestOptions testOpts;
         testOpts.parallel_jobs = m_options.parallelJobs;
         testOpts.quiet = m_options.quiet;
+        testOpts.cache_file = m_options.cacheDir / "test-results";
+        testOpts.force = m_options.force;
+        testOpts.filter = m_options.testFilter;
         return run_tests(m_options.source.string(), testOpts);
     }
 
+    if (m_options.test) {
+        // Read by __builtin_main_test (std/builtin.dmz), that forks the tests when more than one job is allowed
+        if (!m_options.testFilter.empty()) setenv("DMZ_TEST_FILTER", m_options.testFilter.c_str(), 1);
+        int jobs = m_options.parallelJobs <= 0 ? std::thread::hardware_concurrency() : m_options.parallelJobs;
+        setenv("DMZ_TEST_JOBS", std::to_string(jobs).c_str(), 1);
+    }
+
+    // The object of a module is written with the interface that the importers read instead of its source
+    bool writeInterface = m_options.isModule && !m_options.test && !m_options.bench && m_options.source != "-" &&
+                          !m_options.asmDump && !m_options.emitLLVMBC && !m_options.run;
+
+    ptr<Cache> cache;
+    if (cacheable()) {
+        cache = makePtr<Cache>(m_options.cacheDir, m_options.source, cache_configuration());
+        auto module = cache_load_pass(*cache);
+        if (module.second) {
+            m_cachedObjects = cache->objects();
+            int ret = output_pass(module);
+            if (ret == EXIT_SUCCESS && writeInterface) return interface_pass(cache->modules());
+            return ret;
+        }
+    }
+
     auto lexer = lexer_pass(m_options.source);
     if (need_exit()) return exit_code();
     auto ast = parser_pass(std::move(lexer));
@@ -758,20 +1361,25 @@ int Driver::main() {
     import_pass(ast);
     if (need_exit()) return exit_code();
 
+    // The imported modules parsed from their source are cached on their own once the program is built
+    std::vector<std::filesystem::path> uncachedModules;
+    if (cache && !m_options.isModule && !m_options.test && !m_options.bench) {
+        for (auto &&[k, v] : imported_modules) {
+            if (v && v->interfaceObject.empty()) uncachedModules.emplace_back(k);
+        }
+    }
+
     auto resolvedTrees = semantic_pass(std::move(ast));
     if (need_exit()) return exit_code();
 
     auto module = codegen_pass(std::move(resolvedTrees));
     if (need_exit()) return exit_code();
 
-    if (m_options.asmDump) {
-        return asm_pass(module.second);
-    }
+    if (cache) cache_store_pass(*cache, *module.second);
 
-    if (m_options.run) {
-        return jit_pass(module.second);
-    } else {
-        return generate_exec_pass(module.second);
-    }
+    int ret = output_pass(module);
+    if (!uncachedModules.empty()) module_cache_pass(uncachedModules);
+    if (ret == EXIT_SUCCESS && writeInterface) return interface_pass({});
+    return ret;
 }
 }  // namespace DMZ
\ No newline at end of file
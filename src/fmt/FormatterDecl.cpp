@@ -60,6 +60,10 @@ ptr<Node> Formatter::fmt_func_decl(const FuncDecl& fnDecl) {
         ret->nodes.emplace_back(makePtr<Text>("test"));
         ret->nodes.emplace_back(makePtr<Space>());
         ret->nodes.emplace_back(build.string(test->identifier));
+    } else if (auto bench = dynamic_cast<const BenchDecl*>(&fnDecl)) {
+        ret->nodes.emplace_back(makePtr<Text>("bench"));
+        ret->nodes.emplace_back(makePtr<Space>());
+        ret->nodes.emplace_back(build.string(bench->identifier));
     } else {
         vec<ptr<Node>> paramList;
 
@@ -0,0 +1,280 @@
+#include "interface/Interface.hpp"
+
+#include "Debug.hpp"
+#include "Stats.hpp"
+#include "cache/Cache.hpp"
+
+namespace DMZ {
+static constexpr std::string_view s_interfaceHeader = "dmz-interface 2";
+
+template <typename T>
+static void write_value(std::ostream &os, T value) {
+    os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+static void write_string(std::ostream &os, std::string_view str) {
+    write_value<uint32_t>(os, str.size());
+    os.write(str.data(), str.size());
+}
+
+template <typename T>
+static bool read_value(std::istream &is, T &value) {
+    return static_cast<bool>(is.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+static bool read_string(std::istream &is, std::string &str) {
+    uint32_t size = 0;
+    if (!read_value(is, size)) return false;
+    str.resize(size);
+    return static_cast<bool>(is.read(str.data(), size));
+}
+
+// The size and modification time of the object, it is not hashed because it is much bigger than the sources
+static std::optional<std::pair<uint64_t, int64_t>> object_stamp(const std::filesystem::path &object) {
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(object, ec);
+    if (ec) return std::nullopt;
+    int64_t time = std::filesystem::last_write_time(object, ec).time_since_epoch().count();
+    if (ec) return std::nullopt;
+    return std::make_pair(size, time);
+}
+
+// Index of the '{' that opens the body of the function starting at 'fn', or the index of its ';' or eof when it has no
+// body
+static size_t find_function_body(const std::vector<Token> &tokens, size_t fnIndex) {
+    int depth = 0;
+    bool afterArrow = false;
+    for (size_t i = fnIndex; i < tokens.size(); ++i) {
+        TokenType type = tokens[i].type;
+        if (type == TokenType::par_l || type == TokenType::bracket_l) {
+            depth++;
+        } else if (type == TokenType::par_r || type == TokenType::bracket_r) {
+            depth--;
+        } else if (depth == 0 && type == TokenType::return_arrow) {
+            afterArrow = true;
+        } else if (depth == 0 && afterArrow && type == TokenType::block_l) {
+            return i;
+        } else if (type == TokenType::semicolon || type == TokenType::eof) {
+            return i;
+        }
+    }
+    return tokens.size();
+}
+
+static size_t find_matching_block(const std::vector<Token> &tokens, size_t openIndex) {
+    int depth = 0;
+    for (size_t i = openIndex; i < tokens.size(); ++i) {
+        if (tokens[i].type == TokenType::block_l) {
+            depth++;
+        } else if (tokens[i].type == TokenType::block_r && --depth == 0) {
+            return i;
+        }
+    }
+    return tokens.size();
+}
+
+// Removes the comments, the tests and the bodies of the functions that are generated in the module object. The bodies
+// of the generic functions, and of the functions of generic structs, are kept because the importers specialize them.
+static std::vector<Token> interface_tokens(const std::vector<Token> &tokens) {
+    enum class Scope { Block, Struct, GenericStruct };
+    std::vector<Scope> scopes;
+    Scope nextScope = Scope::Block;
+    std::vector<Token> result;
+    result.reserve(tokens.size());
+
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const Token &tok = tokens[i];
+        TokenType type = tok.type;
+        if (type == TokenType::comment || type == TokenType::empty_line) continue;
+
+        if ((type == TokenType::kw_test || type == TokenType::kw_bench) && scopes.empty()) {
+            size_t open = i;
+            while (open < tokens.size() && tokens[open].type != TokenType::block_l) open++;
+            i = find_matching_block(tokens, open);
+            continue;
+        }
+
+        if (type == TokenType::kw_struct || type == TokenType::kw_union) {
+            bool generic = i + 2 < tokens.size() && tokens[i + 2].type == TokenType::op_less;
+            nextScope = generic ? Scope::GenericStruct : Scope::Struct;
+        } else if (type == TokenType::block_l) {
+            scopes.emplace_back(nextScope);
+            nextScope = Scope::Block;
+        } else if (type == TokenType::block_r) {
+            if (!scopes.empty()) scopes.pop_back();
+        }
+
+        bool elidable = scopes.empty() || scopes.back() == Scope::Struct;
+        if (type == TokenType::kw_fn && elidable && i + 2 < tokens.size() && tokens[i + 1].type == TokenType::id &&
+            !tokens[i + 1].str.starts_with("@") && tokens[i + 2].type != TokenType::op_less) {
+            size_t body = find_function_body(tokens, i);
+            if (body < tokens.size() && tokens[body].type == TokenType::block_l) {
+                result.insert(result.end(), tokens.begin() + i, tokens.begin() + body);
+                result.emplace_back(Token{.type = TokenType::semicolon, .str = ";", .loc = tokens[body].loc});
+                i = find_matching_block(tokens, body);
+                continue;
+            }
+        }
+
+        result.emplace_back(tok);
+    }
+    return result;
+}
+
+bool ModuleInterface::write(const std::filesystem::path &source, const std::filesystem::path &path,
+                            const std::filesystem::path &object, std::string_view symbolName,
+                            const std::vector<std::filesystem::path> &imports) {
+    debug_func(source);
+    ScopedTimer(StatType::Interface);
+
+    auto sourceHash = Cache::hash_file(source);
+    if (!sourceHash) return false;
+    auto objectStamp = object_stamp(object);
+    if (!objectStamp) return false;
+    std::vector<uint64_t> importHashes;
+    for (auto &&imported : imports) {
+        auto hash = Cache::hash_file(imported);
+        if (!hash) return false;
+        importHashes.emplace_back(*hash);
+    }
+
+    Lexer lexer(source.string());
+    auto tokens = interface_tokens(lexer.tokenize_file());
+
+    // The strings of the tokens are interned, most of them are identifiers and punctuation that repeat a lot
+    std::vector<std::string_view> strings;
+    std::unordered_map<std::string_view, uint32_t> stringIndex;
+    std::vector<uint32_t> tokenStrings;
+    tokenStrings.reserve(tokens.size());
+    for (auto &&tok : tokens) {
+        auto [it, inserted] = stringIndex.try_emplace(tok.str, strings.size());
+        if (inserted) strings.emplace_back(tok.str);
+        tokenStrings.emplace_back(it->second);
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    std::filesystem::path tmpPath = path;
+    tmpPath += ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+
+        file << s_interfaceHeader << '\n';
+        write_value<uint64_t>(file, Cache::compiler_hash());
+        write_value<uint64_t>(file, *sourceHash);
+        write_string(file, std::filesystem::absolute(object).string());
+        write_value<uint64_t>(file, objectStamp->first);
+        write_value<int64_t>(file, objectStamp->second);
+        write_string(file, symbolName);
+
+        write_value<uint32_t>(file, imports.size());
+        for (size_t i = 0; i < imports.size(); ++i) {
+            write_string(file, std::filesystem::absolute(imports[i]).string());
+            write_value<uint64_t>(file, importHashes[i]);
+        }
+
+        write_value<uint32_t>(file, strings.size());
+        for (auto &&str : strings) write_string(file, str);
+
+        write_value<uint32_t>(file, tokens.size());
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            write_value<uint8_t>(file, static_cast<uint8_t>(tokens[i].type));
+            write_value<uint32_t>(file, tokenStrings[i]);
+            write_value<uint32_t>(file, tokens[i].loc.line);
+            write_value<uint32_t>(file, tokens[i].loc.col);
+        }
+        if (!file) {
+            std::filesystem::remove(tmpPath);
+            return false;
+        }
+    }
+
+    // Renamed at the end so a concurrent import never reads a half written interface
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) std::filesystem::remove(tmpPath, ec);
+    return !ec;
+}
+
+std::optional<ModuleInterface> ModuleInterface::read(const std::filesystem::path &source,
+                                                     const std::filesystem::path &path) {
+    debug_func(source);
+    ScopedTimer(StatType::Interface);
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return std::nullopt;
+
+    std::string line;
+    if (!std::getline(file, line) || line != s_interfaceHeader) return std::nullopt;
+
+    uint64_t compilerHash = 0, sourceHash = 0;
+    if (!read_value(file, compilerHash) || compilerHash != Cache::compiler_hash()) return std::nullopt;
+    if (!read_value(file, sourceHash) || sourceHash != Cache::hash_file(source)) {
+        debug_msg("stale interface of " << source);
+        return std::nullopt;
+    }
+
+    ModuleInterface interface;
+    std::string object;
+    uint64_t objectSize = 0;
+    int64_t objectTime = 0;
+    if (!read_string(file, object) || !read_value(file, objectSize) || !read_value(file, objectTime) ||
+        !read_string(file, interface.symbolName)) {
+        return std::nullopt;
+    }
+    interface.object = object;
+    if (object_stamp(interface.object) != std::make_pair(objectSize, objectTime)) {
+        debug_msg("changed object " << interface.object);
+        return std::nullopt;
+    }
+
+    // The object was compiled against the struct layouts and signatures of the imports as they were
+    uint32_t importCount = 0;
+    if (!read_value(file, importCount)) return std::nullopt;
+    for (uint32_t i = 0; i < importCount; ++i) {
+        std::string imported;
+        uint64_t importHash = 0;
+        if (!read_string(file, imported) || !read_value(file, importHash)) return std::nullopt;
+        if (Cache::hash_file(imported) != importHash) {
+            debug_msg("changed import " << imported << " of " << source);
+            return std::nullopt;
+        }
+    }
+
+    uint32_t stringCount = 0;
+    if (!read_value(file, stringCount)) return std::nullopt;
+    std::string text;
+    std::vector<std::pair<size_t, size_t>> stringRanges(stringCount);
+    for (auto &&[begin, size] : stringRanges) {
+        std::string str;
+        if (!read_string(file, str)) return std::nullopt;
+        begin = text.size();
+        size = str.size();
+        text += str;
+    }
+    interface.buffer = makePtr<SourceBuffer>(std::move(text));
+
+    uint32_t tokenCount = 0;
+    if (!read_value(file, tokenCount)) return std::nullopt;
+    interface.tokens.reserve(tokenCount);
+    uint32_t fileId = SourceManager::instance().file_id(source.string());
+    for (uint32_t i = 0; i < tokenCount; ++i) {
+        uint8_t type = 0;
+        uint32_t str = 0, tokLine = 0, tokCol = 0;
+        if (!read_value(file, type) || !read_value(file, str) || !read_value(file, tokLine) ||
+            !read_value(file, tokCol)) {
+            return std::nullopt;
+        }
+        if (str >= stringRanges.size() || type > static_cast<uint8_t>(TokenType::eof)) return std::nullopt;
+
+        Token &tok = interface.tokens.emplace_back();
+        tok.type = static_cast<TokenType>(type);
+        tok.str = interface.buffer->data().substr(stringRanges[str].first, stringRanges[str].second);
+        tok.loc = {.file_id = fileId,
+                   .line = tokLine,
+                   .col = tokCol,
+                   .len = tok.str.size() > 0 ? static_cast<uint32_t>(tok.str.size()) : 1};
+    }
+    return interface;
+}
+}  // namespace DMZ
@@ -0,0 +1,96 @@
+#include "jit/JIT.hpp"
+
+#include "Debug.hpp"
+#include "Stats.hpp"
+#include "backend/Backend.hpp"
+
+namespace DMZ {
+JIT::JIT(std::string_view optimizationLevel) : m_optimizationLevel(optimizationLevel) {}
+
+bool JIT::create() {
+    debug_func("");
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    auto jtmb = llvm::orc::JITTargetMachineBuilder::detectHost();
+    if (!jtmb) {
+        llvm::consumeError(jtmb.takeError());
+        return false;
+    }
+    jtmb->setCodeGenOptLevel(Backend::codegen_level(m_optimizationLevel));
+
+    auto jit = llvm::orc::LLJITBuilder().setJITTargetMachineBuilder(std::move(*jtmb)).create();
+    if (!jit) {
+        llvm::consumeError(jit.takeError());
+        return false;
+    }
+    m_jit = std::move(*jit);
+
+    // Resolve libc and any other symbol already loaded in the compiler process (printf, malloc, ...)
+    auto generator =
+        llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(m_jit->getDataLayout().getGlobalPrefix());
+    if (!generator) {
+        llvm::consumeError(generator.takeError());
+        m_jit.reset();
+        return false;
+    }
+    m_jit->getMainJITDylib().addGenerator(std::move(*generator));
+    return true;
+}
+
+int JIT::run(ptr<llvm::LLVMContext> context, ptr<llvm::Module> module,
+             const std::vector<std::filesystem::path> &objects) {
+    debug_func("");
+    if (!m_jit) dmz_unreachable("JIT not created");
+
+    int (*mainFn)() = nullptr;
+    {
+        ScopedTimer(StatType::JIT);
+        module->setDataLayout(m_jit->getDataLayout());
+        module->setTargetTriple(m_jit->getTargetTriple().str());
+        Backend::optimize_module(*module, Backend::optimization_level(m_optimizationLevel));
+
+        if (auto err = m_jit->addIRModule(llvm::orc::ThreadSafeModule(std::move(module), std::move(context)))) {
+            llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "error: ");
+            return EXIT_FAILURE;
+        }
+        // Objects of the modules imported from their interface
+        for (auto &&object : objects) {
+            auto buffer = llvm::MemoryBuffer::getFile(object.string());
+            if (!buffer) {
+                llvm::errs() << "error: cannot read '" << object.string() << "': " << buffer.getError().message()
+                             << '\n';
+                return EXIT_FAILURE;
+            }
+            if (auto err = m_jit->addObjectFile(std::move(*buffer))) {
+                llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "error: ");
+                return EXIT_FAILURE;
+            }
+        }
+        if (auto err = m_jit->initialize(m_jit->getMainJITDylib())) {
+            llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "error: ");
+            return EXIT_FAILURE;
+        }
+
+        // Materialize 'main' and everything it references
+        auto mainSym = m_jit->lookup("main");
+        if (!mainSym) {
+            llvm::logAllUnhandledErrors(mainSym.takeError(), llvm::errs(), "error: ");
+            return EXIT_FAILURE;
+        }
+        mainFn = mainSym->toPtr<int (*)()>();
+    }
+
+    int ret;
+    {
+        ScopedTimer(StatType::Run);
+        ret = mainFn();
+        fflush(stdout);
+    }
+
+    if (auto err = m_jit->deinitialize(m_jit->getMainJITDylib())) {
+        llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "error: ");
+    }
+    return ret;
+}
+}  // namespace DMZ
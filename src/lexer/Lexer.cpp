@@ -5,6 +5,8 @@
 #include <cstring>
 
 #include "Debug.hpp"
+#include "Stats.hpp"
+#include "lexer/Scan.hpp"
 
 namespace DMZ {
 std::ostream& operator<<(std::ostream& os, const TokenType& t) {
@@ -94,6 +96,7 @@ std::ostream& operator<<(std::ostream& os, const TokenType& t) {
         CASE_TYPE(kw_switch);
         CASE_TYPE(kw_case);
         CASE_TYPE(kw_test);
+        CASE_TYPE(kw_bench);
         CASE_TYPE(kw_inline);
         CASE_TYPE(kw_break);
         CASE_TYPE(kw_continue);
@@ -126,337 +129,321 @@ std::ostream& operator<<(std::ostream& os, const std::vector<Token>& v_t) {
     return os;
 }
 
-Lexer::Lexer(std::string source_name) : m_source_name(source_name) {
-    if (source_name == "-") {
-        m_input_stream = &std::cin;
-        m_is_cin_stream = true;
-    } else {
-        m_is_cin_stream = false;
+Lexer::Lexer(std::string source_name)
+    : m_source_name(source_name), m_file_id(SourceManager::instance().file_id(source_name)) {}
+
+Lexer::Lexer(std::string source_name, std::string content)
+    : m_source_name(source_name),
+      m_file_id(SourceManager::instance().file_id(source_name)),
+      m_buffer(makePtr<SourceBuffer>(std::move(content))) {
+    m_next_line = m_buffer->begin();
+}
+
+Lexer::Lexer(std::string source_name, std::vector<Token> tokens, ptr<SourceBuffer> buffer, bool isInterface)
+    : m_source_name(source_name),
+      m_file_id(SourceManager::instance().file_id(source_name)),
+      m_buffer(std::move(buffer)),
+      m_replay(true),
+      m_is_interface(isInterface),
+      m_tokens(std::move(tokens)) {}
+
+namespace {
+// What the lexer reads from the first character of a token
+enum class CharKind : uint8_t {
+    Other,
+    Digit,
+    Identifier,
+    String,
+    Char,
+    Slash,
+    Operator,
+};
+
+struct Operator {
+    std::string_view text;
+    TokenType type;
+};
+
+// Grouped by their first character with the longest first, so the first one that matches is the longest (maximal munch)
+constexpr Operator operators[] = {
+    {"->", TokenType::return_arrow},
+    {"-=", TokenType::op_minus_equal},
+    {"--", TokenType::op_minusminus},
+    {"-", TokenType::op_minus},
+    {"=>", TokenType::switch_arrow},
+    {"==", TokenType::op_equal},
+    {"=", TokenType::op_assign},
+    {"+=", TokenType::op_plus_equal},
+    {"++", TokenType::op_plusplus},
+    {"+", TokenType::op_plus},
+    {"*=", TokenType::op_asterisk_equal},
+    {"*", TokenType::asterisk},
+    {"/=", TokenType::op_div_equal},
+    {"/", TokenType::op_div},
+    {"%", TokenType::op_percent},
+    {"&&", TokenType::ampamp},
+    {"&", TokenType::amp},
+    {"||", TokenType::pipepipe},
+    {"|", TokenType::pipe},
+    {"!=", TokenType::op_not_equal},
+    {"!", TokenType::op_excla_mark},
+    {"<=", TokenType::op_less_eq},
+    {"<", TokenType::op_less},
+    {">=", TokenType::op_more_eq},
+    {">", TokenType::op_more},
+    {"...", TokenType::dotdotdot},
+    {"..", TokenType::dotdot},
+    {".", TokenType::dot},
+    {"?", TokenType::op_quest_mark},
+    {"{", TokenType::block_l},
+    {"}", TokenType::block_r},
+    {"(", TokenType::par_l},
+    {")", TokenType::par_r},
+    {"[", TokenType::bracket_l},
+    {"]", TokenType::bracket_r},
+    {":", TokenType::colon},
+    {";", TokenType::semicolon},
+    {",", TokenType::comma},
+};
+
+struct CharInfo {
+    CharKind kind = CharKind::Other;
+    // Operators that start with the character
+    uint8_t firstOperator = 0;
+    uint8_t operatorCount = 0;
+};
+
+constexpr std::array<CharInfo, 256> make_char_table() {
+    std::array<CharInfo, 256> table{};
+    for (int c = 0; c < 256; c++) {
+        bool alpha = ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z');
+        bool digit = '0' <= c && c <= '9';
+        if (digit) table[c].kind = CharKind::Digit;
+        if (alpha || c == '_' || c == '@') table[c].kind = CharKind::Identifier;
     }
+    table['"'].kind = CharKind::String;
+    table['\''].kind = CharKind::Char;
+    for (size_t i = 0; i < std::size(operators); i++) {
+        CharInfo& info = table[static_cast<unsigned char>(operators[i].text[0])];
+        if (info.operatorCount == 0) {
+            info.kind = CharKind::Operator;
+            info.firstOperator = i;
+        }
+        info.operatorCount++;
+    }
+    // Also the start of a comment
+    table['/'].kind = CharKind::Slash;
+    return table;
+}
+
+constexpr std::array<CharInfo, 256> charTable = make_char_table();
+
+constexpr bool operators_grouped() {
+    for (size_t i = 0; i < std::size(operators); i++) {
+        const CharInfo& info = charTable[static_cast<unsigned char>(operators[i].text[0])];
+        if (i < info.firstOperator || i >= info.firstOperator + info.operatorCount) return false;
+    }
+    return true;
 }
+static_assert(operators_grouped(), "the operators that start with the same character must be together");
 
-Lexer::Lexer(std::string source_name, std::string content) : m_source_name(source_name) {
-    m_input_stream_file = makePtr<std::stringstream>(content);
-    m_input_stream = m_input_stream_file.get();
-    m_is_cin_stream = false;
+inline const CharInfo& char_info(char c) { return charTable[static_cast<unsigned char>(c)]; }
+
+// Perfect hash of the keywords by their first and last characters and their size
+constexpr size_t keywordSlots = 128;
+constexpr size_t keyword_hash(std::string_view str) {
+    return (static_cast<unsigned char>(str.front()) * 25 + static_cast<unsigned char>(str.back()) * 45 +
+            str.size() * 2) %
+           keywordSlots;
 }
 
-static inline bool isSpace(const std::string_view& c) {
-    return c.size() > 0 &&
-           (c[0] == ' ' || c[0] == '\f' || c[0] == '\n' || c[0] == '\r' || c[0] == '\t' || c[0] == '\v');
+constexpr std::array<std::pair<std::string_view, TokenType>, keywordSlots> make_keyword_table() {
+    std::array<std::pair<std::string_view, TokenType>, keywordSlots> table{};
+    for (auto&& keyword : keywords) {
+        table[keyword_hash(keyword.first)] = keyword;
+    }
+    return table;
 }
-static inline bool isAlpha(const std::string_view& c) {
-    return c.size() > 0 && (('a' <= c[0] && c[0] <= 'z') || ('A' <= c[0] && c[0] <= 'Z'));
+
+constexpr std::array<std::pair<std::string_view, TokenType>, keywordSlots> keywordTable = make_keyword_table();
+
+constexpr bool keywords_collide() {
+    for (auto&& keyword : keywords) {
+        if (keywordTable[keyword_hash(keyword.first)].first != keyword.first) return true;
+    }
+    return false;
 }
-static inline bool isDigit(const std::string_view& c) { return c.size() > 0 && '0' <= c[0] && c[0] <= '9'; }
+static_assert(!keywords_collide(), "two keywords have the same hash, change the multipliers of keyword_hash");
+
+TokenType identifier_type(std::string_view str) {
+    if (str.size() > 1 && (str[0] == 'i' || str[0] == 'u')) {
+        bool isInteger = true;
+        for (size_t i = 1; i < str.size(); i++) {
+            if (char_info(str[i]).kind != CharKind::Digit) {
+                isInteger = false;
+                break;
+            }
+        }
+        if (isInteger) return str[0] == 'i' ? TokenType::ty_iN : TokenType::ty_uN;
+    }
+    auto&& [text, type] = keywordTable[keyword_hash(str)];
+    return text == str ? type : TokenType::id;
+}
+}  // namespace
 
-static inline bool isAlnum(const std::string_view& c) { return isDigit(c) || isAlpha(c); }
 bool Lexer::next_line() {
     debug_msg("");
 
-    if (!m_input_stream) {
-        if (!m_is_cin_stream) {
-            m_input_stream_file = makePtr<std::ifstream>(m_source_name);
-            m_input_stream = m_input_stream_file.get();
-            if (!m_input_stream->good()) {
-                m_input_stream_file.reset();
-                m_input_stream = nullptr;
-                dmz_unreachable("unexpected cannot open " + m_source_name + " " + std::strerror(errno));
-            }
-        } else {
-            dmz_unreachable("Lexer was not initialized with a valid input stream.");
-        }
+    if (!m_buffer) {
+        m_buffer = SourceBuffer::open(m_source_name);
+        if (!m_buffer) dmz_unreachable("unexpected cannot open " + m_source_name + " " + std::strerror(errno));
+        m_next_line = m_buffer->begin();
     }
 
-    m_line_buffer.clear();
-    if (!std::getline(*m_input_stream, m_line_buffer)) {
+    if (m_next_line == m_buffer->end()) {
         debug_msg("no more lines");
         return false;
     }
 
-    debug_msg("read line " << m_line << " '" + m_line_buffer + "'");
+    m_line_begin = m_next_line;
+    m_line_end = static_cast<const char*>(std::memchr(m_line_begin, '\n', m_buffer->end() - m_line_begin));
+    if (!m_line_end) m_line_end = m_buffer->end();
+    m_next_line = m_line_end == m_buffer->end() ? m_line_end : m_line_end + 1;
+    m_cur = m_line_begin;
+
+    debug_msg("read line " << m_line << " '" << std::string_view(m_line_begin, m_line_end - m_line_begin) << "'");
     m_line++;
-    m_col = 0;
     return true;
 }
 
 bool Lexer::advance(int num) {
     debug_msg("num " << num);
     if (num <= 0) return true;
-    // debug_msg("m_col " << m_col << " new m_col " << m_col + num);
-    m_col += num;
-    return m_col < m_line_buffer.size();
+    m_cur += num;
+    return m_cur < m_line_end;
 }
 
-Token Lexer::next_token() {
-    debug_msg("m_col " << m_col << " m_line_buffer.size() " << m_line_buffer.size());
-    if (m_line_buffer.size() == 0 || m_col == m_line_buffer.size()) {
+Token Lexer::next_token() { return read_token(); }
+
+Token Lexer::read_token() {
+    debug_msg("col " << col() << " line size " << m_line_end - m_line_begin);
+    if (m_replay) {
+        if (m_next_token < m_tokens.size()) return m_tokens[m_next_token++];
+        return Token{.type = TokenType::eof, .loc = {.file_id = m_file_id}};
+    }
+    if (m_cur >= m_line_end) {
         if (!next_line()) {
-            return Token{.type = TokenType::eof, .loc = {.file_name = m_source_name, .line = m_line, .col = m_col}};
+            return Token{.type = TokenType::eof, .loc = {.file_id = m_file_id, .line = m_line, .col = col()}};
         }
     }
-    std::string_view line_content(m_line_buffer);
-    line_content = line_content.substr(m_col);
-    debug_msg("current line: " << m_line << " current col: " << m_col << " content '" << line_content << "'");
-    size_t space_count = 0;
     // Consume spaces
-    while (isSpace(line_content.substr(space_count, 1))) {
-        space_count++;
-    }
-    advance(space_count);
+    const char* start = m_cur;
+    m_cur = scan_spaces(m_cur, m_line_end);
+    std::string_view line_content(m_cur, m_line_end - m_cur);
+    debug_msg("current line: " << m_line << " current col: " << col() << " content '" << line_content << "'");
 
-    line_content = line_content.substr(space_count);
-    Token t{.type = TokenType::invalid, .loc = {.file_name = m_source_name, .line = m_line, .col = m_col}};
+    Token t{.type = TokenType::invalid, .loc = {.file_id = m_file_id, .line = m_line, .col = col()}};
     if (line_content.empty()) {
-        if (m_col == space_count) {
+        if (start == m_line_begin) {
             t.type = TokenType::empty_line;
             return t;
         } else {
-            return next_token();
+            return read_token();
         }
     }
 
     defer([&]() { debug_msg(t); });
-    if (line_content.substr(0, 1) == "\0") {
-        t.type = TokenType::eof;
-    } else if (isDigit(line_content.substr(0, 1))) {
-        size_t digit_count = 1;
-        while (isDigit(line_content.substr(digit_count, 1))) {
-            digit_count++;
-        }
-        if (line_content.substr(digit_count, 1) != "." || line_content.substr(digit_count, 2) == "..") {
-            t.type = TokenType::lit_int;
-            t.str = line_content.substr(0, digit_count);
-            advance(digit_count);
-            return t;
-        }
-        digit_count++;  // the '.'
-        if (!isDigit(line_content.substr(digit_count, 1))) {
-            t.type = TokenType::unknown;
+    const CharInfo& info = char_info(line_content[0]);
+    switch (info.kind) {
+        case CharKind::Digit: {
+            const char* end = m_cur + 1;
+            while (end < m_line_end && char_info(*end).kind == CharKind::Digit) {
+                end++;
+            }
+            size_t digit_count = end - m_cur;
+            if (line_content.substr(digit_count, 1) != "." || line_content.substr(digit_count, 2) == "..") {
+                t.type = TokenType::lit_int;
+                t.str = line_content.substr(0, digit_count);
+                advance(digit_count);
+                return t;
+            }
+            end++;  // the '.'
+            if (end == m_line_end || char_info(*end).kind != CharKind::Digit) {
+                t.type = TokenType::unknown;
+                t.str = line_content.substr(0, digit_count + 1);
+                advance(digit_count + 1);
+                return t;
+            }
+            while (end < m_line_end && char_info(*end).kind == CharKind::Digit) {
+                end++;
+            }
+            digit_count = end - m_cur;
+            t.type = TokenType::lit_float;
             t.str = line_content.substr(0, digit_count);
             advance(digit_count);
-            return t;
+            break;
         }
-        while (isDigit(line_content.substr(digit_count, 1))) {
-            digit_count++;
+        case CharKind::Identifier: {
+            const char* end = scan_identifier(m_cur + 1, m_line_end);
+            t.str = line_content.substr(0, end - m_cur);
+            t.type = identifier_type(t.str);
+            advance(t.str.size());
+            break;
         }
-        t.type = TokenType::lit_float;
-        t.str = line_content.substr(0, digit_count);
-        advance(digit_count);
-
-    } else if (isAlpha(line_content.substr(0, 1)) || line_content.substr(0, 1) == "_" ||
-               line_content.substr(0, 1) == "@") {
-        size_t alpha_count = 1;
-        while (isAlnum(line_content.substr(alpha_count, 1)) || line_content.substr(alpha_count, 1) == "_") {
-            alpha_count++;
+        case CharKind::String: {
+            // An unterminated string is left invalid at the end of the line
+            const char* end = static_cast<const char*>(std::memchr(m_cur + 1, '"', m_line_end - m_cur - 1));
+            if (!end) {
+                m_cur = m_line_end;
+                return t;
+            }
+            size_t str_count = end - m_cur + 1;
+            advance(str_count);
+            t.type = TokenType::lit_string;
+            t.str = line_content.substr(0, str_count);
+            break;
         }
-        t.type = TokenType::id;
-        t.str = line_content.substr(0, alpha_count);
-        advance(alpha_count);
-        auto it = keywords.find(t.str);
-        if (it != keywords.end()) {
-            t.type = it->second;
+        case CharKind::Char: {
+            int char_size = 1;
+            if (line_content.substr(char_size, 1) == "\\") {
+                char_size++;
+            }
+            char_size++;
+            if (!advance(char_size)) return t;
+            if (line_content.substr(char_size, 1) != "\'") {
+                t.type = TokenType::unknown;
+                t.str = line_content.substr(1, char_size);
+                return t;
+            }
+            advance();
+            char_size++;
+            t.type = TokenType::lit_char;
+            t.str = line_content.substr(0, char_size);
+            break;
         }
-        if (t.str.size() > 1 && (t.str[0] == 'i' || t.str[0] == 'u')) {
-            bool isInteger = true;
-            for (size_t i = 1; i < t.str.size(); i++) {
-                if (!std::isdigit(t.str[i])) {
-                    isInteger = false;
+        case CharKind::Slash:
+            if (line_content.substr(0, 2) == "//") {
+                t.type = TokenType::comment;
+                t.str = line_content;
+                advance(line_content.size());
+                break;
+            }
+            [[fallthrough]];
+        case CharKind::Operator:
+            for (size_t i = info.firstOperator; i < info.firstOperator + info.operatorCount; i++) {
+                if (line_content.starts_with(operators[i].text)) {
+                    t.type = operators[i].type;
+                    t.str = line_content.substr(0, operators[i].text.size());
                     break;
                 }
             }
-            if (isInteger && t.str[0] == 'i') t.type = TokenType::ty_iN;
-            if (isInteger && t.str[0] == 'u') t.type = TokenType::ty_uN;
-        }
-
-    } else if (line_content.substr(0, 2) == "//") {
-        t.type = TokenType::comment;
-        t.str = line_content;
-        advance(line_content.size());
-    } else if (line_content.substr(0, 1) == "{") {
-        t.type = TokenType::block_l;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 1) == "}") {
-        t.type = TokenType::block_r;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 1) == "(") {
-        t.type = TokenType::par_l;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 1) == ")") {
-        t.type = TokenType::par_r;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 1) == "[") {
-        t.type = TokenType::bracket_l;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 1) == "]") {
-        t.type = TokenType::bracket_r;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 1) == ":") {
-        t.type = TokenType::colon;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 1) == ";") {
-        t.type = TokenType::semicolon;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 1) == ",") {
-        t.type = TokenType::comma;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 1) == "\"") {
-        size_t str_count = 1;
-        if (!advance()) return t;
-        while (line_content.substr(str_count, 1) != "\"" && line_content.substr(str_count, 1) != "\n") {
-            str_count++;
-            if (!advance()) return t;
-        }
-        // For last "
-        str_count++;
-        advance();
-        t.type = TokenType::lit_string;
-        t.str = line_content.substr(0, str_count);
-    } else if (line_content.substr(0, 1) == "\'") {
-        int char_size = 1;
-        if (line_content.substr(char_size, 1) == "\\") {
-            char_size++;
-        }
-        char_size++;
-        if (!advance(char_size)) return t;
-        if (line_content.substr(char_size, 1) != "\'") {
+            advance(t.str.size());
+            break;
+        case CharKind::Other:
             t.type = TokenType::unknown;
-            t.str = line_content.substr(1, char_size);
-            return t;
-        }
-        advance();
-        char_size++;
-        t.type = TokenType::lit_char;
-        t.str = line_content.substr(0, char_size);
-    } else if (line_content.substr(0, 2) == "->") {
-        t.type = TokenType::return_arrow;
-        t.str = line_content.substr(0, 2);
-        advance(2);
-    } else if (line_content.substr(0, 2) == "=>") {
-        t.type = TokenType::switch_arrow;
-        t.str = line_content.substr(0, 2);
-        advance(2);
-    } else if (line_content.substr(0, 2) == "+=") {
-        t.type = TokenType::op_plus_equal;
-        t.str = line_content.substr(0, 2);
-        advance(2);
-    } else if (line_content.substr(0, 2) == "++") {
-        t.type = TokenType::op_plusplus;
-        t.str = line_content.substr(0, 2);
-        advance(2);
-    } else if (line_content.substr(0, 1) == "+") {
-        t.type = TokenType::op_plus;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 2) == "-=") {
-        t.type = TokenType::op_minus_equal;
-        t.str = line_content.substr(0, 2);
-        advance(2);
-    } else if (line_content.substr(0, 2) == "--") {
-        t.type = TokenType::op_minusminus;
-        t.str = line_content.substr(0, 2);
-        advance(2);
-    } else if (line_content.substr(0, 1) == "-") {
-        t.type = TokenType::op_minus;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 2) == "*=") {
-        t.type = TokenType::op_asterisk_equal;
-        t.str = line_content.substr(0, 2);
-        advance(2);
-    } else if (line_content.substr(0, 1) == "*") {
-        t.type = TokenType::asterisk;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 2) == "/=") {
-        t.type = TokenType::op_div_equal;
-        t.str = line_content.substr(0, 2);
-        advance(2);
-    } else if (line_content.substr(0, 1) == "/") {
-        t.type = TokenType::op_div;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 1) == "%") {
-        t.type = TokenType::op_percent;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 2) == "&&") {
-        t.type = TokenType::ampamp;
-        t.str = line_content.substr(0, 2);
-        advance(2);
-    } else if (line_content.substr(0, 2) == "||") {
-        t.type = TokenType::pipepipe;
-        t.str = line_content.substr(0, 2);
-        advance(2);
-    } else if (line_content.substr(0, 2) == "==") {
-        t.type = TokenType::op_equal;
-        t.str = line_content.substr(0, 2);
-        advance(2);
-    } else if (line_content.substr(0, 1) == "=") {
-        t.type = TokenType::op_assign;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 2) == "!=") {
-        t.type = TokenType::op_not_equal;
-        t.str = line_content.substr(0, 2);
-        advance(2);
-    } else if (line_content.substr(0, 2) == "<=") {
-        t.type = TokenType::op_less_eq;
-        t.str = line_content.substr(0, 2);
-        advance(2);
-    } else if (line_content.substr(0, 2) == ">=") {
-        t.type = TokenType::op_more_eq;
-        t.str = line_content.substr(0, 2);
-        advance(2);
-    } else if (line_content.substr(0, 1) == "<") {
-        t.type = TokenType::op_less;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 1) == ">") {
-        t.type = TokenType::op_more;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 3) == "...") {
-        t.type = TokenType::dotdotdot;
-        t.str = line_content.substr(0, 3);
-        advance(3);
-    } else if (line_content.substr(0, 2) == "..") {
-        t.type = TokenType::dotdot;
-        t.str = line_content.substr(0, 2);
-        advance(2);
-    } else if (line_content.substr(0, 1) == ".") {
-        t.type = TokenType::dot;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 1) == "|") {
-        t.type = TokenType::pipe;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 1) == "&") {
-        t.type = TokenType::amp;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 1) == "?") {
-        t.type = TokenType::op_quest_mark;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else if (line_content.substr(0, 1) == "!") {
-        t.type = TokenType::op_excla_mark;
-        t.str = line_content.substr(0, 1);
-        advance();
-    } else {
-        t.type = TokenType::unknown;
-        t.str = line_content.substr(0, 1);
-        advance();
+            t.str = line_content.substr(0, 1);
+            advance();
+            break;
     }
     debug_msg(t);
     t.loc.len = t.str.size() > 0 ? t.str.size() : 1;
@@ -467,9 +454,6 @@ std::vector<Token> Lexer::tokenize_file() {
     debug_msg("Begin");
     std::vector<Token> v_tokens;
 
-    m_line = 0;
-    m_col = 0;
-
     Token result;
     do {
         result = v_tokens.emplace_back(next_token());
@@ -479,4 +463,21 @@ std::vector<Token> Lexer::tokenize_file() {
     return v_tokens;
 }
 
+void Lexer::tokenize() {
+    if (m_replay) return;
+    uint64_t allocCount = AllocationCounter::count;
+    uint64_t allocBytes = AllocationCounter::bytes;
+    auto start = std::chrono::high_resolution_clock::now();
+    m_tokens = tokenize_file();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    m_replay = true;
+    m_next_token = 0;
+
+    auto &stats = Stats::instance();
+    stats.add_time(StatType::Parse_Lexer, elapsed.count());
+    stats.add_allocations(StatType::Parse_Lexer, AllocationCounter::count - allocCount,
+                          AllocationCounter::bytes - allocBytes);
+    stats.add_count(CounterType::Tokens, m_tokens.size());
+}
+
 }  // namespace DMZ
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "lexer/Scan.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DMZ_SCAN_X86
+#endif
+
+namespace DMZ {
+
+static inline bool is_space(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+static inline bool is_identifier(char c) {
+    return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9') || c == '_';
+}
+
+static const char* spaces_scalar(const char* begin, const char* end) {
+    while (begin < end && is_space(*begin)) begin++;
+    return begin;
+}
+
+static const char* identifier_scalar(const char* begin, const char* end) {
+    while (begin < end && is_identifier(*begin)) begin++;
+    return begin;
+}
+
+#ifdef DMZ_SCAN_X86
+// The comparisons are signed, so the bytes from 0x80 are out of every range
+
+__attribute__((target("sse2"))) static const char* spaces_sse2(const char* begin, const char* end) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i low = _mm_set1_epi8('\t' - 1);
+    const __m128i high = _mm_set1_epi8('\r' + 1);
+    for (; end - begin >= 16; begin += 16) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i control = _mm_and_si128(_mm_cmpgt_epi8(c, low), _mm_cmplt_epi8(c, high));
+        unsigned mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(c, space), control));
+        if (mask != 0xFFFF) return begin + __builtin_ctz(~mask);
+    }
+    return spaces_scalar(begin, end);
+}
+
+__attribute__((target("sse2"))) static const char* identifier_sse2(const char* begin, const char* end) {
+    // The letters are checked in lower case, setting the bit 0x20 only maps 'A'-'Z' into 'a'-'z'
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    const __m128i lowA = _mm_set1_epi8('a' - 1);
+    const __m128i highZ = _mm_set1_epi8('z' + 1);
+    const __m128i low0 = _mm_set1_epi8('0' - 1);
+    const __m128i high9 = _mm_set1_epi8('9' + 1);
+    const __m128i underscore = _mm_set1_epi8('_');
+    for (; end - begin >= 16; begin += 16) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i lower = _mm_or_si128(c, caseBit);
+        __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, lowA), _mm_cmplt_epi8(lower, highZ));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, low0), _mm_cmplt_epi8(c, high9));
+        __m128i ok = _mm_or_si128(_mm_or_si128(alpha, digit), _mm_cmpeq_epi8(c, underscore));
+        unsigned mask = _mm_movemask_epi8(ok);
+        if (mask != 0xFFFF) return begin + __builtin_ctz(~mask);
+    }
+    return identifier_scalar(begin, end);
+}
+
+__attribute__((target("avx2"))) static const char* spaces_avx2(const char* begin, const char* end) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i low = _mm256_set1_epi8('\t' - 1);
+    const __m256i high = _mm256_set1_epi8('\r' + 1);
+    for (; end - begin >= 32; begin += 32) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i control = _mm256_and_si256(_mm256_cmpgt_epi8(c, low), _mm256_cmpgt_epi8(high, c));
+        uint32_t mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(c, space), control));
+        if (mask != 0xFFFFFFFF) return begin + __builtin_ctz(~mask);
+    }
+    return spaces_sse2(begin, end);
+}
+
+__attribute__((target("avx2"))) static const char* identifier_avx2(const char* begin, const char* end) {
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+    const __m256i lowA = _mm256_set1_epi8('a' - 1);
+    const __m256i highZ = _mm256_set1_epi8('z' + 1);
+    const __m256i low0 = _mm256_set1_epi8('0' - 1);
+    const __m256i high9 = _mm256_set1_epi8('9' + 1);
+    const __m256i underscore = _mm256_set1_epi8('_');
+    for (; end - begin >= 32; begin += 32) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i lower = _mm256_or_si256(c, caseBit);
+        __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, lowA), _mm256_cmpgt_epi8(highZ, lower));
+        __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(c, low0), _mm256_cmpgt_epi8(high9, c));
+        __m256i ok = _mm256_or_si256(_mm256_or_si256(alpha, digit), _mm256_cmpeq_epi8(c, underscore));
+        uint32_t mask = _mm256_movemask_epi8(ok);
+        if (mask != 0xFFFFFFFF) return begin + __builtin_ctz(~mask);
+    }
+    return identifier_sse2(begin, end);
+}
+#endif
+
+namespace {
+struct Scanner {
+    std::string_view isa;
+    const char* (*spaces)(const char* begin, const char* end);
+    const char* (*identifier)(const char* begin, const char* end);
+};
+
+Scanner select_scanner() {
+#ifdef DMZ_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return {"avx2", spaces_avx2, identifier_avx2};
+    if (__builtin_cpu_supports("sse2")) return {"sse2", spaces_sse2, identifier_sse2};
+#endif
+    return {"scalar", spaces_scalar, identifier_scalar};
+}
+
+const Scanner scanner = select_scanner();
+}  // namespace
+
+const char* scan_spaces(const char* begin, const char* end) { return scanner.spaces(begin, end); }
+
+const char* scan_identifier(const char* begin, const char* end) { return scanner.identifier(begin, end); }
+
+std::string_view scan_isa() { return scanner.isa; }
+}  // namespace DMZ
@@ -0,0 +1,57 @@
+#include "lexer/SourceBuffer.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Debug.hpp"
+
+namespace DMZ {
+
+// Below it a copy costs less than the mapping, and a file truncated while it is compiled cannot fault
+static constexpr off_t mapThreshold = 1 << 20;
+
+SourceBuffer::SourceBuffer(std::string content) : m_content(std::move(content)) { m_data = m_content; }
+
+SourceBuffer::~SourceBuffer() {
+    if (m_mapping) munmap(m_mapping, m_mapping_size);
+}
+
+ptr<SourceBuffer> SourceBuffer::open(const std::string& path) {
+    debug_func(path);
+    if (path == "-") {
+        return makePtr<SourceBuffer>(
+            std::string((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>()));
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+    defer([&] { close(fd); });
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) return nullptr;
+    // The small files are read, the ones that are not regular (pipes, ...) cannot be mapped
+    if (S_ISREG(st.st_mode) && st.st_size >= mapThreshold) {
+        void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+            ptr<SourceBuffer> buffer(new SourceBuffer());
+            buffer->m_mapping = mapping;
+            buffer->m_mapping_size = st.st_size;
+            buffer->m_data = std::string_view(static_cast<const char*>(mapping), st.st_size);
+            return buffer;
+        }
+    }
+
+    std::string content;
+    if (S_ISREG(st.st_mode)) content.reserve(st.st_size);
+    char chunk[65536];
+    ssize_t count;
+    while ((count = read(fd, chunk, sizeof(chunk))) > 0) {
+        content.append(chunk, count);
+    }
+    if (count < 0) return nullptr;
+    return makePtr<SourceBuffer>(std::move(content));
+}
+}  // namespace DMZ
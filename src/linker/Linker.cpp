@@ -1,24 +1,72 @@
 #include "linker/Linker.hpp"
 
+#include "Debug.hpp"
+
 namespace DMZ {
-Linker::Linker(std::vector<ptr<llvm::orc::ThreadSafeModule>> modules) : m_modules(std::move(modules)) {}
+Linker::Linker(std::vector<std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>>> modules, unsigned flags)
+    : m_modules(std::move(modules)), m_flags(flags) {}
+
+Linker::Linker(std::vector<std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>>> modules,
+               std::vector<std::pair<std::string, std::string>> bitcodes, unsigned flags)
+    : m_modules(std::move(modules)), m_bitcodes(std::move(bitcodes)), m_flags(flags) {}
 
-ptr<llvm::orc::ThreadSafeModule> Linker::link_modules() {
-    if (m_modules.size() == 1) return std::move(m_modules[0]);
+std::string Linker::write_bitcode(llvm::Module &module) {
+    std::string bitcode;
+    llvm::raw_string_ostream out(bitcode);
+    llvm::WriteBitcodeToFile(module, out);
+    out.flush();
+    return bitcode;
+}
 
-    llvm::Linker linker(*m_modules[0]->getModuleUnlocked());
+void Linker::remove_unused_declarations(llvm::Module &module) {
+    for (auto &&function : llvm::make_early_inc_range(module.functions())) {
+        if (function.isDeclaration() && function.use_empty()) function.eraseFromParent();
+    }
+    for (auto &&global : llvm::make_early_inc_range(module.globals())) {
+        if (global.isDeclaration() && global.use_empty()) global.eraseFromParent();
+    }
+}
+
+bool Linker::link_bitcode(llvm::Linker &linker, llvm::LLVMContext &context, const std::string &identifier,
+                          const std::string &bitcode) {
+    auto moved = llvm::parseBitcodeFile(llvm::MemoryBufferRef(bitcode, identifier), context);
+    if (!moved) {
+        llvm::logAllUnhandledErrors(moved.takeError(), llvm::errs(), "error: ");
+        return false;
+    }
+    return !linker.linkInModule(std::move(*moved), m_flags);
+}
+
+std::pair<ptr<llvm::LLVMContext>, ptr<llvm::Module>> Linker::link_modules() {
+    debug_func("");
+    if (m_modules.empty()) return {};
+    if (m_modules.size() == 1 && m_bitcodes.empty()) return std::move(m_modules[0]);
+
+    llvm::LLVMContext &context = *m_modules[0].first;
+    llvm::Linker linker(*m_modules[0].second);
 
-    std::vector<ptr<llvm::Module>> modulesPtrs;
     for (size_t i = 1; i < m_modules.size(); i++) {
-        m_modules[i]->consumingModuleDo([&](auto M) {
-            // println("--------------------------------------");
-            // M->dump();
-            // println("--------------------------------------");
-            linker.linkInModule(std::move(M), llvm::Linker::Flags::LinkOnlyNeeded);
-        });
+        auto [sourceContext, source] = std::move(m_modules[i]);
+
+        // A module can only be linked into one of the same context, the others are moved through bitcode
+        if (&source->getContext() != &context) {
+            std::string identifier = source->getModuleIdentifier();
+            std::string bitcode = write_bitcode(*source);
+            source.reset();
+            sourceContext.reset();
+            if (!link_bitcode(linker, context, identifier, bitcode)) return {};
+            continue;
+        }
+
+        if (linker.linkInModule(std::move(source), m_flags)) return {};
+    }
+
+    for (auto &&[identifier, bitcode] : m_bitcodes) {
+        if (!link_bitcode(linker, context, identifier, bitcode)) return {};
+        // The bitcode is not needed once it is parsed
+        std::string().swap(bitcode);
     }
 
     return std::move(m_modules[0]);
-    // return makePtr<llvm::orc::ThreadSafeModule>(std::move(modulesPtrs[0]), m_modules[0]->getContext());
 }
 }  // namespace DMZ
@@ -8,10 +8,10 @@
 namespace DMZ::lsp {
 
 NodeFinder::NodeFinder(const std::string& file, size_t line, size_t col)
-    : found_decl(nullptr), m_target_file(file), m_line(line), m_col(col) {}
+    : found_decl(nullptr), m_target_file(SourceManager::instance().file_id(file)), m_line(line), m_col(col) {}
 
 bool NodeFinder::is_at_location(const SourceLocation& loc, size_t length) const {
-    if (loc.file_name != m_target_file) return false;
+    if (loc.file_id != m_target_file) return false;
     if (loc.line != m_line) return false;
     if (m_col < loc.col) return false;
     if (length == 0) return m_col == loc.col;
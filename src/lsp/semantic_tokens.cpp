@@ -8,7 +8,7 @@
 namespace DMZ::lsp {
 
 SemanticTokensCollector::SemanticTokensCollector(const std::string& target_file, const std::string& source)
-    : m_target_file(target_file), m_source(source) {}
+    : m_target_file(SourceManager::instance().file_id(target_file)), m_source(source) {}
 
 std::vector<SemanticToken> SemanticTokensCollector::collect(const std::vector<ptr<ResolvedModuleDecl>>& resolvedAST) {
     m_tokens.clear();
@@ -34,7 +34,7 @@ void SemanticTokensCollector::traverse_module(const ResolvedModuleDecl& module)
 
 void SemanticTokensCollector::traverse_decl(const ResolvedDecl& decl) {
     debug_msg(decl.location);
-    if (decl.location.file_name == m_target_file) {
+    if (decl.location.file_id == m_target_file) {
         if (auto* structDecl = dynamic_cast<const ResolvedStructDecl*>(&decl)) {
             if (structDecl->isTuple) return;
             add_token(structDecl->location, structDecl->identifier, SemanticTokenType::Type,
@@ -60,7 +60,7 @@ void SemanticTokensCollector::traverse_decl(const ResolvedDecl& decl) {
                 traverse_decl(*func);
             }
         } else if (auto* funcDecl = dynamic_cast<const ResolvedFuncDecl*>(&decl)) {
-            if (!dynamic_cast<const ResolvedTestDecl*>(funcDecl)) {
+            if (!dynamic_cast<const ResolvedTestDecl*>(funcDecl) && !dynamic_cast<const ResolvedBenchDecl*>(funcDecl)) {
                 if (!dynamic_cast<const ResolvedLambdaFunctionDecl*>(funcDecl)) {
                     add_token(funcDecl->location, funcDecl->identifier, SemanticTokenType::Function,
                               (uint32_t)SemanticTokenModifier::Declaration);
@@ -170,7 +170,7 @@ void SemanticTokensCollector::traverse_stmt(const ResolvedStmt& stmt) {
 
 void SemanticTokensCollector::traverse_expr(const ResolvedExpr& expr) {
     debug_msg(expr.location);
-    if (expr.location.file_name == m_target_file) {
+    if (expr.location.file_id == m_target_file) {
         if (auto* declRef = dynamic_cast<const ResolvedDeclRefExpr*>(&expr)) {
             debug_msg("ResolvedDeclRefExpr");
 
@@ -366,7 +366,7 @@ void SemanticTokensCollector::traverse_expr(const ResolvedExpr& expr) {
 void SemanticTokensCollector::traverse_type(const ResolvedType& type) {
     debug_msg(type.location << " " << type.to_str());
     if (auto* structTy = dynamic_cast<const ResolvedTypeStruct*>(&type)) {
-        if (structTy->location.file_name == m_target_file) {
+        if (structTy->location.file_id == m_target_file) {
             add_token(structTy->location, structTy->is_this ? "@This" : structTy->decl->identifier,
                       SemanticTokenType::Type);
         }
@@ -374,7 +374,7 @@ void SemanticTokensCollector::traverse_type(const ResolvedType& type) {
             if (specStru->specializedTypes) traverse_type(*specStru->specializedTypes);
         }
     } else if (auto* structDecl = dynamic_cast<const ResolvedTypeStructDecl*>(&type)) {
-        if (structDecl->location.file_name == m_target_file) {
+        if (structDecl->location.file_id == m_target_file) {
             add_token(structDecl->location, structDecl->is_this ? "@This" : structDecl->decl->identifier,
                       SemanticTokenType::Type);
         }
@@ -382,19 +382,19 @@ void SemanticTokensCollector::traverse_type(const ResolvedType& type) {
             if (specStru->specializedTypes) traverse_type(*specStru->specializedTypes);
         }
     } else if (auto* unionTy = dynamic_cast<const ResolvedTypeUnion*>(&type)) {
-        if (unionTy->location.file_name == m_target_file) {
+        if (unionTy->location.file_id == m_target_file) {
             add_token(unionTy->location, unionTy->is_this ? "@This" : unionTy->decl->identifier,
                       SemanticTokenType::Type);
         }
     } else if (auto* unionDecl = dynamic_cast<const ResolvedTypeUnionDecl*>(&type)) {
-        if (unionDecl->location.file_name == m_target_file) {
+        if (unionDecl->location.file_id == m_target_file) {
             add_token(unionDecl->location, unionDecl->is_this ? "@This" : unionDecl->decl->identifier,
                       SemanticTokenType::Type);
         }
     } else if (dynamic_cast<const ResolvedTypeNumber*>(&type) || dynamic_cast<const ResolvedTypeVoid*>(&type) ||
                dynamic_cast<const ResolvedTypeGeneric*>(&type) || dynamic_cast<const ResolvedTypeBool*>(&type) ||
                dynamic_cast<const ResolvedTypeError*>(&type)) {
-        if (type.location.file_name == m_target_file) {
+        if (type.location.file_id == m_target_file) {
             add_token(type.location, type.to_str(), SemanticTokenType::Type);
         }
     } else if (auto* ptrTy = dynamic_cast<const ResolvedTypePointer*>(&type)) {
@@ -417,7 +417,7 @@ void SemanticTokensCollector::traverse_type(const ResolvedType& type) {
 
 void SemanticTokensCollector::add_token(const SourceLocation& loc, std::string_view identifier, SemanticTokenType type,
                                         uint32_t modifiers) {
-    if (loc.file_name != m_target_file) return;
+    if (loc.file_id != m_target_file) return;
     if (loc.line == 0 || identifier.empty()) return;
 
     size_t col = loc.col;
@@ -433,7 +433,7 @@ void SemanticTokensCollector::add_token(const SourceLocation& loc, std::string_v
             if (end_of_line == std::string::npos) end_of_line = m_source.length();
 
             std::string_view line_str(m_source.data() + line_start, end_of_line - line_start);
-            size_t search_start = std::min(loc.col, line_str.length());
+            size_t search_start = std::min<size_t>(loc.col, line_str.length());
             size_t pos = line_str.find(identifier, search_start);
             if (pos == std::string_view::npos && search_start > 0) {
                 pos = line_str.find(identifier, 0);
@@ -191,7 +191,7 @@ void LSPServer::on_definition(const std::string& id, const std::string& params)
                   << finder.found_decl->location << std::endl;
         const auto& loc = finder.found_decl->location;
         std::stringstream ss;
-        ss << "{\"uri\":\"file://" << loc.file_name << "\",\"range\":{"
+        ss << "{\"uri\":\"file://" << loc.file_name() << "\",\"range\":{"
            << "\"start\":{\"line\":" << (loc.line - 1) << ",\"character\":" << loc.col << "},"
            << "\"end\":{\"line\":" << (loc.line - 1)
            << ",\"character\":" << (loc.col + finder.found_decl->identifier.length()) << "}"
@@ -303,7 +303,7 @@ void LSPServer::collect_module_completions(const ResolvedModuleDecl* decl, std::
     if (!decl) return;
     for (const auto& d : decl->declarations) {
         if (!d->isPublic) continue;
-        if (dynamic_cast<const ResolvedTestDecl*>(d.get())) continue;
+        if (dynamic_cast<const ResolvedTestDecl*>(d.get()) || dynamic_cast<const ResolvedBenchDecl*>(d.get())) continue;
         if (has_items) items << ",";
         int kind = 1;   // Default
         if (dynamic_cast<const ResolvedFunctionDecl*>(d.get()))
@@ -408,7 +408,7 @@ const ResolvedType* LSPServer::find_incomplete_member_base_type(const std::vecto
         void visit_expr(const ResolvedExpr& expr) {
             if (result) return;
             if (const auto* me = dynamic_cast<const ResolvedMemberExpr*>(&expr)) {
-                if (me->member.identifier.empty() && me->location.file_name == target_file &&
+                if (me->member.identifier.empty() && me->location.file_name() == target_file &&
                     me->location.line == target_line) {
                     result = me->base->type.get();
                     return;
@@ -584,7 +584,7 @@ void LSPServer::process_file(const std::string& filename, const std::string& sou
         }
 
         if (Driver::instance_ptr()) {
-            Driver::instance().m_options = opts;
+            Driver::instance().reset(opts);
             Driver::instance().imported_modules.clear();
         } else {
             Driver::create_instance(opts);
@@ -647,7 +647,7 @@ void LSPServer::process_file(const std::string& filename, const std::string& sou
             if (msg_start == std::string::npos) continue;
 
             std::string msg = line.substr(msg_start);
-            errors.push_back({f, (size_t)l, (size_t)c});
+            errors.push_back({SourceManager::instance().file_id(f), (uint32_t)l, (uint32_t)c});
             messages.push_back(msg);
         } catch (...) {
             continue;
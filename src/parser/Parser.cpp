@@ -18,6 +18,12 @@ bool Parser::is_top_stmt_level_token(TokenType tok) { return top_stmt_level_toke
 std::pair<ptr<ModuleDecl>, bool> Parser::parse_source_file() {
     debug_func(m_lexer.get_file_path());
     ScopedTimer(StatType::Parse);
+    uint64_t astNodes = t_astNodes;
+    defer([&] {
+        if (Stats::enabled()) Stats::instance().add_count(CounterType::ASTNodes, t_astNodes - astNodes);
+    });
+    if (Stats::enabled()) m_lexer.tokenize();
+    eat_next_token();
 
     auto declarations = parse_in_module_decl();
 
@@ -26,7 +32,7 @@ std::pair<ptr<ModuleDecl>, bool> Parser::parse_source_file() {
     }
 
     auto file_path = m_lexer.get_file_path();
-    SourceLocation location = {.file_name = file_path, .line = 1, .col = 0};
+    SourceLocation location = {.file_id = SourceManager::instance().file_id(file_path.string()), .line = 1, .col = 0};
     auto module_name = file_path.filename().replace_extension("").string();
     auto mod = makePtr<ModuleDecl>(location, std::move(module_name), std::move(file_path), std::move(declarations));
     debug_msg("Incomplete AST " << (m_incompleteAST ? "true" : "false"));
@@ -79,6 +79,13 @@ ptr<FuncDecl> Parser::parse_function_decl() {
                                            std::move(*parameterList));
     }
 
+    // The interface of a module only keeps the signature of the functions defined in its object
+    if (m_lexer.is_interface() && genericTypes.empty() && m_nextToken.type == TokenType::semicolon) {
+        eat_next_token();  // eat ';'
+        return makePtr<FunctionDecl>(loc, isPublic, functionIdentifier, std::move(type), std::move(*parameterList),
+                                     nullptr);
+    }
+
     matchOrReturn(TokenType::block_l, "expected function body");
     varOrReturn(block, parse_block());
 
@@ -427,6 +434,11 @@ std::vector<ptr<Decl>> Parser::parse_in_module_decl() {
                 declarations.emplace_back(std::move(test));
                 continue;
             }
+        } else if (ttype == TokenType::kw_bench) {
+            if (auto bench = parse_bench_decl()) {
+                declarations.emplace_back(std::move(bench));
+                continue;
+            }
         } else if (ttype == TokenType::comment) {
             if (auto comment = parse_comment()) {
                 declarations.emplace_back(std::move(comment));
@@ -464,6 +476,22 @@ ptr<TestDecl> Parser::parse_test_decl() {
     return makePtr<TestDecl>(location, name, std::move(block));
 }
 
+ptr<BenchDecl> Parser::parse_bench_decl() {
+    auto location = m_nextToken.loc;
+    matchOrReturn(TokenType::kw_bench, "expected 'bench'");
+    eat_next_token();  // eat bench
+
+    matchOrReturn(TokenType::lit_string, "expected string literal");
+    auto name = m_nextToken.str;
+    name = name.substr(1, name.size() - 2);
+    eat_next_token();  // eat name
+
+    matchOrReturn(TokenType::block_l, "expected function body");
+    varOrReturn(block, parse_block());
+
+    return makePtr<BenchDecl>(location, name, std::move(block));
+}
+
 ptr<CaptureDecl> Parser::parse_capture_decl() {
     auto location = m_nextToken.loc;
     auto identifier = m_nextToken.str;
@@ -243,7 +243,6 @@ ptr<Expr> Parser::parse_postfix_expr(ptr<Expr> expr) {
         return parse_postfix_expr(std::move(expr));
     }
     if (!(restrictions & (StructNotAllowed | OnlyTypeExpr)) && m_nextToken.type == TokenType::block_l) {
-        SourceLocation location = m_nextToken.loc;
         bool haveTrailingComma;
         auto fieldInitList = parse_list_with_trailing_comma<FieldInitStmt>(
             {TokenType::block_l, "expected '{'"}, [this]() { return parse_field_init_stmt(); },
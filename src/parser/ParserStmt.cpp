@@ -401,7 +401,6 @@ ptr<CaseStmt> Parser::parse_case_stmt() {
 
 ptr<Block> Parser::parse_else_stmt() {
     debug_func("");
-    auto location = m_nextToken.loc;
     matchOrReturn(TokenType::kw_else, "expected else");
     eat_next_token();  // eat else
     matchOrReturn(TokenType::switch_arrow, "expected =>");
@@ -66,6 +66,8 @@ void FunctionDecl::dump(size_t level) const {
         std::cerr << indent(level) << "MemberFunctionDecl ";
     } else if (dynamic_cast<const TestDecl *>(this)) {
         std::cerr << indent(level) << "TestDecl ";
+    } else if (dynamic_cast<const BenchDecl *>(this)) {
+        std::cerr << indent(level) << "BenchDecl ";
     } else {
         std::cerr << indent(level) << "FunctionDecl ";
     }
@@ -73,7 +75,7 @@ void FunctionDecl::dump(size_t level) const {
 
     for (auto &&param : params) param->dump(level + 1);
 
-    body->dump(level + 1);
+    if (body) body->dump(level + 1);
 }
 
 std::string FunctionDecl::to_str() const { dmz_unreachable("TODO"); }
@@ -534,7 +536,11 @@ std::string ImportExpr::to_str() const { dmz_unreachable("TODO"); }
 
 void TestDecl::dump(size_t level) const { FunctionDecl::dump(level); }
 
-std::string TestDecl::to_str() const { dmz_unreachable("TODO"); }
+std::string TestDecl::to_str() const { return "test \"" + identifier + "\""; }
+
+void BenchDecl::dump(size_t level) const { FunctionDecl::dump(level); }
+
+std::string BenchDecl::to_str() const { return "bench \"" + identifier + "\""; }
 
 void LambdaExpr::dump(size_t level) const {
     std::cerr << indent(level) << "LambdaExpr\n";
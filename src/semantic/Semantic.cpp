@@ -626,7 +626,7 @@ void Sema::fill_depends(ResolvedDependencies *parent, std::vector<ptr<ResolvedDe
     }
 }
 
-bool Sema::recurse_needed(ResolvedDependencies &resolvedDeps, bool buildTest,
+bool Sema::recurse_needed(ResolvedDependencies &resolvedDeps, bool buildTest, bool buildBench,
                           std::unordered_set<ResolvedDependencies *> &recurse_check) {
     bool ret = false;
     bool isReasonRecurse = false;
@@ -651,6 +651,12 @@ bool Sema::recurse_needed(ResolvedDependencies &resolvedDeps, bool buildTest,
         return ret;
     }
 
+    if (!buildBench && dynamic_cast<const ResolvedBenchDecl *>(&resolvedDeps)) {
+        debug_msg("ResolvedDecl is a bench and not necesary");
+        ret = false;
+        return ret;
+    }
+
     if (dynamic_cast<const ResolvedModuleDecl *>(&resolvedDeps)) {
         debug_msg("ResolvedModuleDecl is empty");
         ret = false;
@@ -669,6 +675,12 @@ bool Sema::recurse_needed(ResolvedDependencies &resolvedDeps, bool buildTest,
         return ret;
     }
 
+    if (m_exportedDecls.contains(&resolvedDeps)) {
+        debug_msg(resolvedDeps.name() << " is needed exported");
+        ret = true;
+        return ret;
+    }
+
     if (resolvedDeps.identifier == "main") {
         debug_msg(resolvedDeps.name() << " is needed main");
         ret = true;
@@ -681,6 +693,12 @@ bool Sema::recurse_needed(ResolvedDependencies &resolvedDeps, bool buildTest,
         return ret;
     }
 
+    if (buildBench && resolvedDeps.identifier == "__builtin_main_bench") {
+        debug_msg(resolvedDeps.name() << " is needed buildBench or __builtin_main_bench");
+        ret = true;
+        return ret;
+    }
+
     if (resolvedDeps.isUsedBy.size() == 1) {
         debug_msg(resolvedDeps.name() << " " << (*resolvedDeps.isUsedBy.begin())->name());
         if (*resolvedDeps.isUsedBy.begin() == &resolvedDeps) {
@@ -698,7 +716,7 @@ bool Sema::recurse_needed(ResolvedDependencies &resolvedDeps, bool buildTest,
             reasonRecurse += 1;
             continue;
         }
-        if (recurse_needed(*decl, buildTest, recurse_check)) {
+        if (recurse_needed(*decl, buildTest, buildBench, recurse_check)) {
             debug_msg(decl->name() << " is needed recurse");
             ret = true;
             return ret;
@@ -713,13 +731,26 @@ bool Sema::recurse_needed(ResolvedDependencies &resolvedDeps, bool buildTest,
     return ret;
 }
 
-void Sema::remove_unused(std::vector<ptr<ResolvedModuleDecl>> &moduleDecls, bool buildTest) {
+void Sema::export_module(const ResolvedModuleDecl &moduleDecl) {
+    debug_func(moduleDecl.name());
+    for (auto &&decl : moduleDecl.declarations) {
+        m_exportedDecls.emplace(decl.get());
+        if (const auto *sd = dynamic_cast<const ResolvedStructDecl *>(decl.get())) {
+            for (auto &&func : sd->functions) m_exportedDecls.emplace(func.get());
+        } else if (const auto *ud = dynamic_cast<const ResolvedUnionDecl *>(decl.get())) {
+            for (auto &&func : ud->functions) m_exportedDecls.emplace(func.get());
+        }
+    }
+}
+
+void Sema::remove_unused(std::vector<ptr<ResolvedModuleDecl>> &moduleDecls, bool buildTest, bool buildBench) {
+    ScopedTimer(StatType::Semantic_RemoveUnused);
     auto aux_vector = move_vector_ptr<ResolvedModuleDecl, ResolvedDecl>(moduleDecls);
-    remove_unused(aux_vector, buildTest);
+    remove_unused(aux_vector, buildTest, buildBench);
     moduleDecls = move_vector_ptr<ResolvedDecl, ResolvedModuleDecl>(aux_vector);
 }
 
-void Sema::remove_unused(std::vector<ptr<ResolvedDecl>> &decls, bool buildTest) {
+void Sema::remove_unused(std::vector<ptr<ResolvedDecl>> &decls, bool buildTest, bool buildBench) {
     debug_func("");
 
     auto add_to_remove = [](ptr<DMZ::ResolvedDecl> &d) {
@@ -744,7 +775,7 @@ void Sema::remove_unused(std::vector<ptr<ResolvedDecl>> &decls, bool buildTest)
         }
         if (auto md = dynamic_cast<ResolvedModuleDecl *>(decl.get())) {
             debug_msg("ModuleDecl " << md->identifier);
-            remove_unused(md->declarations, buildTest);
+            remove_unused(md->declarations, buildTest, buildBench);
             if (md->declarations.empty()) {
                 add_to_remove(decl);
             }
@@ -755,20 +786,20 @@ void Sema::remove_unused(std::vector<ptr<ResolvedDecl>> &decls, bool buildTest)
                 debug_msg("ResolvedGenericStructDecl " << gen->identifier);
 
                 auto aux_decls = move_vector_ptr<ResolvedSpecializedStructDecl, ResolvedDecl>(gen->specializations);
-                remove_unused(aux_decls, buildTest);
+                remove_unused(aux_decls, buildTest, buildBench);
                 gen->specializations = move_vector_ptr<ResolvedDecl, ResolvedSpecializedStructDecl>(aux_decls);
 
-                if (!recurse_needed(*gen, buildTest, recurse_check)) {
+                if (!recurse_needed(*gen, buildTest, buildBench, recurse_check)) {
                     add_to_remove(decl);
                 }
             }
             debug_msg("StructDecl " << sd->identifier);
 
             auto aux_decls = move_vector_ptr<ResolvedMemberFunctionDecl, ResolvedDecl>(sd->functions);
-            remove_unused(aux_decls, buildTest);
+            remove_unused(aux_decls, buildTest, buildBench);
             sd->functions = move_vector_ptr<ResolvedDecl, ResolvedMemberFunctionDecl>(aux_decls);
 
-            if (!recurse_needed(*sd, buildTest, recurse_check)) {
+            if (!recurse_needed(*sd, buildTest, buildBench, recurse_check)) {
                 add_to_remove(decl);
             }
             continue;
@@ -778,23 +809,23 @@ void Sema::remove_unused(std::vector<ptr<ResolvedDecl>> &decls, bool buildTest)
                 debug_msg("ResolvedGenericFunctionDecl " << gen->identifier);
 
                 auto aux_decls = move_vector_ptr<ResolvedSpecializedFunctionDecl, ResolvedDecl>(gen->specializations);
-                remove_unused(aux_decls, buildTest);
+                remove_unused(aux_decls, buildTest, buildBench);
                 gen->specializations = move_vector_ptr<ResolvedDecl, ResolvedSpecializedFunctionDecl>(aux_decls);
 
-                if (!recurse_needed(*gen, buildTest, recurse_check)) {
+                if (!recurse_needed(*gen, buildTest, buildBench, recurse_check)) {
                     add_to_remove(decl);
                 }
             }
 
             debug_msg("FuncDecl " << fd->identifier);
-            if (!recurse_needed(*fd, buildTest, recurse_check)) {
+            if (!recurse_needed(*fd, buildTest, buildBench, recurse_check)) {
                 add_to_remove(decl);
             }
             continue;
         }
         if (auto deps = dynamic_cast<ResolvedDependencies *>(decl.get())) {
             debug_msg("ResolvedDependencies " << deps->identifier);
-            if (!recurse_needed(*deps, buildTest, recurse_check)) {
+            if (!recurse_needed(*deps, buildTest, buildBench, recurse_check)) {
                 add_to_remove(decl);
             }
             continue;
@@ -1046,7 +1077,8 @@ void Sema::resolve_symbol_names(const std::vector<ptr<ResolvedModuleDecl>> &decl
                 stack.push(elem{decl.get(), e.level + 1, e.symbol});
             }
         } else if (dynamic_cast<const ResolvedDeclStmt *>(e.decl) || dynamic_cast<const ResolvedFuncDecl *>(e.decl) ||
-                   dynamic_cast<const ResolvedErrorDecl *>(e.decl) || dynamic_cast<const ResolvedTestDecl *>(e.decl)) {
+                   dynamic_cast<const ResolvedErrorDecl *>(e.decl) || dynamic_cast<const ResolvedTestDecl *>(e.decl) ||
+                   dynamic_cast<const ResolvedBenchDecl *>(e.decl)) {
         } else {
             e.decl->dump(0, true);
             dmz_unreachable("TODO: unexpected declaration");
@@ -4,6 +4,7 @@
 #endif
 #endif
 #include "Debug.hpp"
+#include "Stats.hpp"
 #include "Utils.hpp"
 #include "semantic/Semantic.hpp"
 #include "semantic/SemanticSymbolsTypes.hpp"
@@ -149,6 +150,11 @@ ptr<ResolvedFuncDecl> Sema::resolve_function_decl(const FuncDecl &function) {
             ret->getFnType()->fnDecl = ret.get();
             return ret;
         }
+        if (dynamic_cast<const BenchDecl *>(&function)) {
+            auto ret = makePtr<ResolvedBenchDecl>(function.location, function.identifier, functionDecl, nullptr);
+            ret->getFnType()->fnDecl = ret.get();
+            return ret;
+        }
         if (resolvedGenericTypeDecl.size() != 0) {
             auto ret = makePtr<ResolvedGenericFunctionDecl>(
                 function.location, function.isPublic, function.identifier, std::move(fnType), std::move(resolvedParams),
@@ -172,6 +178,7 @@ ResolvedSpecializedFunctionDecl *Sema::specialize_generic_function(const SourceL
                                                                    ResolvedGenericFunctionDecl &funcDecl,
                                                                    const ResolvedTypeSpecialized &genericTypes) {
     debug_func(funcDecl.location);
+    dmz_profile_scope_args("Specialize function", funcDecl.identifier);
     if (funcDecl.genericTypeDecls.size() != genericTypes.specializedTypes.size()) {
         return report(location, "unexpected number of specializations, expected " +
                                     std::to_string(funcDecl.genericTypeDecls.size()) + " actual " +
@@ -256,6 +263,9 @@ ResolvedSpecializedFunctionDecl *Sema::specialize_generic_function(const SourceL
     resolvedFunc->getFnType()->fnDecl = resolvedFunc.get();
     // auto &retFunc = resolvedFunc;
     auto *retFunc = funcDecl.specializations.emplace_back(std::move(resolvedFunc)).get();
+    if (Stats::enabled()) Stats::instance().add_count(CounterType::Specializations);
+    if (Stats::decls_enabled()) Stats::instance().add_instantiation(&funcDecl, funcDecl.name());
+    ScopedDeclTimer(retFunc, retFunc->name(), &funcDecl, false);
     bool error = false;
     auto prevFunc = m_currentFunction;
     m_currentFunction = retFunc;
@@ -333,6 +343,9 @@ ResolvedSpecializedStructDecl *Sema::specialize_generic_struct(const SourceLocat
         castPtr<ResolvedTypeSpecialized>(genericTypes.clone()));
 
     auto *retStruct = struDecl.specializations.emplace_back(std::move(resolvedStruct)).get();
+    if (Stats::enabled()) Stats::instance().add_count(CounterType::Specializations);
+    if (Stats::decls_enabled()) Stats::instance().add_instantiation(&struDecl, struDecl.name());
+    ScopedDeclTimer(retStruct, retStruct->name(), &struDecl, false);
     retStruct->specializedTypes = castPtr<ResolvedTypeSpecialized>(genericTypes.clone());
     add_dependency(retStruct);
 
@@ -531,6 +544,7 @@ bool Sema::resolve_union_body_funcs(ResolvedUnionDecl &resolvedUnionDecl) {
 
     for (size_t i = 0; i < resolvedUnionDecl.functions.size(); i++) {
         auto &resfunc = resolvedUnionDecl.functions[i];
+        if (!resfunc->functionDecl->body) continue;
         if (!resolve_func_body(*resfunc, *resfunc->functionDecl->body)) return false;
     }
 
@@ -676,6 +690,7 @@ bool Sema::resolve_struct_body_funcs(ResolvedStructDecl &resolvedStructDecl) {
 
         for (size_t i = 0; i < resolvedStructDecl.functions.size(); i++) {
             auto &resfunc = resolvedStructDecl.functions[i];
+            if (!resfunc->functionDecl->body) continue;
             if (!resolve_func_body(*resfunc, *resfunc->functionDecl->body)) return false;
         }
     }
@@ -824,6 +839,9 @@ ptr<ResolvedModuleDecl> Sema::resolve_module_decl(const ModuleDecl &moduleDecl)
 
     auto modDecl = makePtr<ResolvedModuleDecl>(moduleDecl.location, moduleDecl.identifier, moduleDecl,
                                                moduleDecl.module_path, std::vector<ptr<DMZ::ResolvedDecl>>{});
+    // The symbols of its object were named when the module was built
+    if (!moduleDecl.interfaceSymbol.empty()) modDecl->symbolName = moduleDecl.interfaceSymbol;
+    modDecl->interfaceObject = moduleDecl.interfaceObject;
 
     return modDecl;
 }
@@ -937,11 +955,16 @@ bool Sema::resolve_module_function_decls(ResolvedModuleDecl &resolvedModuleDecl,
             debug_msg(decl->identifier << " " << decl->location);
             auto resolvedDecl = resolve_function_decl(*fn);
             if (resolvedModuleDecl.module_path == sourcePath) {
-                if (auto *test = dynamic_cast<ResolvedTestDecl *>(resolvedDecl.get())) {
-                    auto it = std::find_if(m_tests.begin(), m_tests.end(),
-                                           [test](ResolvedTestDecl *t) { return t->identifier == test->identifier; });
-                    if (it == m_tests.end()) {
-                        m_tests.emplace_back(test);
+                std::vector<ResolvedFunctionDecl *> *entries = nullptr;
+                if (dynamic_cast<ResolvedTestDecl *>(resolvedDecl.get())) entries = &m_tests;
+                if (dynamic_cast<ResolvedBenchDecl *>(resolvedDecl.get())) entries = &m_benches;
+                if (entries) {
+                    auto *entry = static_cast<ResolvedFunctionDecl *>(resolvedDecl.get());
+                    auto it = std::find_if(entries->begin(), entries->end(), [entry](ResolvedFunctionDecl *e) {
+                        return e->identifier == entry->identifier;
+                    });
+                    if (it == entries->end()) {
+                        entries->emplace_back(entry);
                     }
                 }
             }
@@ -957,6 +980,7 @@ bool Sema::resolve_module_function_decls(ResolvedModuleDecl &resolvedModuleDecl,
 
 bool Sema::resolve_module_body(ResolvedModuleDecl &moduleDecl) {
     debug_func("");
+    dmz_profile_scope_args("Resolve module", moduleDecl.module_path);
     auto prevModule = m_currentModule;
     m_currentModule = &moduleDecl;
     defer([&]() { m_currentModule = prevModule; });
@@ -1005,6 +1029,8 @@ bool Sema::resolve_module_body(ResolvedModuleDecl &moduleDecl) {
         }
         if (auto *fn = dynamic_cast<ResolvedFunctionDecl *>(currentDecl)) {
             if (resolve_builtin_function(*fn)) continue;
+            // Declared by a module interface, the body is compiled in the module object
+            if (!fn->functionDecl->body) continue;
 
             if (!resolve_func_body(*fn, *fn->functionDecl->body)) {
                 debug_msg("error resolve_func_body");
@@ -1043,6 +1069,8 @@ bool Sema::resolve_pending_body() {
 
 bool Sema::resolve_func_body(ResolvedFunctionDecl &function, const Block &body) {
     debug_func("");
+    dmz_profile_scope_args("Resolve function", function.identifier);
+    ScopedDeclTimer(&function, function.name(), nullptr, false);
     ScopeRAII paramScope(*this);
     if (auto *genFn = dynamic_cast<ResolvedGenericFunctionDecl *>(&function)) {
         for (auto &&genType : genFn->genericTypeDecls) {
@@ -1068,23 +1096,36 @@ bool Sema::resolve_builtin_function(const ResolvedFunctionDecl &fnDecl) {
     m_currentFunction = const_cast<ResolvedFunctionDecl *>(&fnDecl);
     defer([&]() { m_currentFunction = prevFunc; });
     if (fnDecl.identifier == "@builtin_test_num") {
-        resolve_builtin_test_num(fnDecl);
+        resolve_builtin_num(fnDecl, m_tests);
         return true;
     }
     if (fnDecl.identifier == "@builtin_test_name") {
-        resolve_builtin_test_name(fnDecl);
+        resolve_builtin_name(fnDecl, m_tests);
         return true;
     }
     if (fnDecl.identifier == "@builtin_test_run") {
-        resolve_builtin_test_run(fnDecl);
+        resolve_builtin_run(fnDecl, m_tests);
+        return true;
+    }
+    if (fnDecl.identifier == "@builtin_bench_num") {
+        resolve_builtin_num(fnDecl, m_benches);
+        return true;
+    }
+    if (fnDecl.identifier == "@builtin_bench_name") {
+        resolve_builtin_name(fnDecl, m_benches);
+        return true;
+    }
+    if (fnDecl.identifier == "@builtin_bench_run") {
+        resolve_builtin_run(fnDecl, m_benches);
         return true;
     }
     return false;
 }
 
-void Sema::resolve_builtin_test_num(const ResolvedFunctionDecl &fnDecl) {
-    SourceLocation loc{.file_name = "builtin"};
-    auto test_num = makePtr<ResolvedIntLiteral>(loc, m_tests.size());
+// The test and bench builtins index the tests or benchmarks of the source module, in declaration order
+void Sema::resolve_builtin_num(const ResolvedFunctionDecl &fnDecl, const std::vector<ResolvedFunctionDecl *> &decls) {
+    SourceLocation loc{.file_id = SourceManager::instance().file_id("builtin")};
+    auto test_num = makePtr<ResolvedIntLiteral>(loc, decls.size());
     auto retStmt = makePtr<ResolvedReturnStmt>(loc, std::move(test_num), std::vector<ptr<DMZ::ResolvedDeferRefStmt>>{});
     std::vector<ptr<ResolvedStmt>> blockStmts;
     blockStmts.emplace_back(std::move(retStmt));
@@ -1095,20 +1136,20 @@ void Sema::resolve_builtin_test_num(const ResolvedFunctionDecl &fnDecl) {
     mutfnDecl->body = std::move(body);
 }
 
-void Sema::resolve_builtin_test_name(const ResolvedFunctionDecl &fnDecl) {
+void Sema::resolve_builtin_name(const ResolvedFunctionDecl &fnDecl, const std::vector<ResolvedFunctionDecl *> &decls) {
     // Begin Body
-    SourceLocation loc{.file_name = "builtin"};
+    SourceLocation loc{.file_id = SourceManager::instance().file_id("builtin")};
     auto cond = makePtr<ResolvedDeclRefExpr>(loc, *fnDecl.params[0], fnDecl.params[0]->type->clone());
 
-    auto elseName = makePtr<ResolvedStringLiteral>(loc, "Error in builtin_test_name");
+    auto elseName = makePtr<ResolvedStringLiteral>(loc, "Error in " + fnDecl.identifier.substr(1));
     auto retStmt = makePtr<ResolvedReturnStmt>(loc, std::move(elseName), std::vector<ptr<ResolvedDeferRefStmt>>{});
     std::vector<ptr<ResolvedStmt>> retBlockStmts;
     retBlockStmts.emplace_back(std::move(retStmt));
 
     auto elseBlock = makePtr<ResolvedBlock>(loc, std::move(retBlockStmts), std::vector<ptr<ResolvedDeferRefStmt>>{});
     std::vector<ptr<ResolvedCaseStmt>> cases;
-    for (size_t i = 0; i < m_tests.size(); i++) {
-        auto test_name = makePtr<ResolvedStringLiteral>(loc, m_tests[i]->name());
+    for (size_t i = 0; i < decls.size(); i++) {
+        auto test_name = makePtr<ResolvedStringLiteral>(loc, decls[i]->name());
         auto retStmt = makePtr<ResolvedReturnStmt>(loc, std::move(test_name), std::vector<ptr<ResolvedDeferRefStmt>>{});
         std::vector<ptr<ResolvedStmt>> retBlockStmts;
         retBlockStmts.emplace_back(std::move(retStmt));
@@ -1131,19 +1172,19 @@ void Sema::resolve_builtin_test_name(const ResolvedFunctionDecl &fnDecl) {
     mutfnDecl->body = std::move(body);
 }
 
-void Sema::resolve_builtin_test_run(const ResolvedFunctionDecl &fnDecl) {
+void Sema::resolve_builtin_run(const ResolvedFunctionDecl &fnDecl, const std::vector<ResolvedFunctionDecl *> &decls) {
     // Begin Body
-    SourceLocation loc{.file_name = "builtin"};
+    SourceLocation loc{.file_id = SourceManager::instance().file_id("builtin")};
     auto cond = makePtr<ResolvedDeclRefExpr>(loc, *fnDecl.params[0], fnDecl.params[0]->type->clone());
 
     auto elseBlock =
         makePtr<ResolvedBlock>(loc, std::vector<ptr<ResolvedStmt>>{}, std::vector<ptr<ResolvedDeferRefStmt>>{});
     std::vector<ptr<ResolvedCaseStmt>> cases;
-    for (size_t i = 0; i < m_tests.size(); i++) {
-        add_dependency(const_cast<ResolvedTestDecl *>(m_tests[i]));
+    for (size_t i = 0; i < decls.size(); i++) {
+        add_dependency(decls[i]);
 
-        auto testType = m_tests[i]->getFnType();
-        auto test_ref = makePtr<ResolvedDeclRefExpr>(loc, *m_tests[i], testType->clone());
+        auto testType = decls[i]->getFnType();
+        auto test_ref = makePtr<ResolvedDeclRefExpr>(loc, *decls[i], testType->clone());
         auto test_call = makePtr<ResolvedCallExpr>(loc, testType->returnType->clone(), std::move(test_ref),
                                                    std::vector<ptr<ResolvedExpr>>{});
         auto returnOptType = dynamic_cast<const ResolvedTypeOptional *>(testType->returnType.get());
@@ -1214,7 +1214,7 @@ ptr<ResolvedImportExpr> Sema::resolve_import_expr(const ImportExpr &importExpr)
     }
 
     auto im = (*it).second;
-    im->symbolName = importExpr.module_id;
+    if (im->interfaceObject.empty()) im->symbolName = importExpr.module_id;
 
     return makePtr<ResolvedImportExpr>(importExpr.location, *im);
 }
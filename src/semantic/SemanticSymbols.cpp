@@ -249,6 +249,8 @@ void ResolvedFunctionDecl::dump(size_t level, bool onlySelf) const {
         }
     } else if (dynamic_cast<const ResolvedTestDecl *>(this)) {
         std::cerr << indent(level) << "ResolvedTestDecl ";
+    } else if (dynamic_cast<const ResolvedBenchDecl *>(this)) {
+        std::cerr << indent(level) << "ResolvedBenchDecl ";
     } else {
         std::cerr << indent(level) << "ResolvedFunctionDecl ";
     }
@@ -648,6 +650,8 @@ void ResolvedImportExpr::dump(size_t level, bool onlySelf) const {
 
 void ResolvedTestDecl::dump(size_t level, bool onlySelf) const { ResolvedFunctionDecl::dump(level, onlySelf); }
 
+void ResolvedBenchDecl::dump(size_t level, bool onlySelf) const { ResolvedFunctionDecl::dump(level, onlySelf); }
+
 void ResolvedGenericExpr::dump(size_t level, bool onlySelf) const {
     std::cerr << indent(level) << "ResolvedGenericExpr:" << type->to_str() << " " << decl.identifier << '\n';
     if (onlySelf) return;
@@ -0,0 +1,393 @@
+#include "server/Server.hpp"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Debug.hpp"
+
+namespace DMZ::server {
+
+static bool write_all(int fd, const void *data, size_t size) {
+    const char *buffer = static_cast<const char *>(data);
+    while (size > 0) {
+        ssize_t written = write(fd, buffer, size);
+        if (written == -1 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        buffer += written;
+        size -= written;
+    }
+    return true;
+}
+
+static bool read_all(int fd, void *data, size_t size) {
+    char *buffer = static_cast<char *>(data);
+    while (size > 0) {
+        ssize_t readed = read(fd, buffer, size);
+        if (readed == -1 && errno == EINTR) continue;
+        if (readed <= 0) return false;
+        buffer += readed;
+        size -= readed;
+    }
+    return true;
+}
+
+static bool make_address(const std::filesystem::path &path, sockaddr_un &address) {
+    std::string str = path.string();
+    if (str.size() >= sizeof(address.sun_path)) return false;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, str.c_str(), str.size() + 1);
+    return true;
+}
+
+// The request starts with the size of the payload, the standard streams of the client go with it
+static bool send_request_header(int fd, uint32_t size) {
+    int fds[3] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+    iovec iov = {&size, sizeof(size)};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))] = {};
+
+    msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+    return sendmsg(fd, &msg, 0) == sizeof(size);
+}
+
+static bool receive_request_header(int fd, uint32_t &size, int (&fds)[3]) {
+    iovec iov = {&size, sizeof(size)};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))] = {};
+
+    msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(fd, &msg, MSG_CMSG_CLOEXEC) != sizeof(size)) return false;
+
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN(sizeof(fds))) return false;
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    return true;
+}
+
+// The arguments and the paths of a request are far below it, a bigger size is not a client of this compiler
+static constexpr uint32_t maxRequestSize = 1 << 20;
+// Seconds to receive a request once connected
+static constexpr time_t requestTimeout = 5;
+
+// Only a process of the same user can send its streams to the server or receive the ones of the client
+static bool same_user(int fd) {
+    ucred credentials;
+    socklen_t size = sizeof(credentials);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &size) == -1) return false;
+    return credentials.uid == getuid();
+}
+
+// A directory that only this user can access, so no other user can create the socket first
+static bool private_directory(const std::filesystem::path &path) {
+    if (mkdir(path.c_str(), 0700) == -1 && errno != EEXIST) return false;
+    struct stat st;
+    if (lstat(path.c_str(), &st) == -1) return false;
+    return S_ISDIR(st.st_mode) && st.st_uid == getuid() && (st.st_mode & 0077) == 0;
+}
+
+std::filesystem::path socket_path(const CompilerOptions &options) {
+    if (!options.socketPath.empty()) return options.socketPath;
+    if (const char *runtimeDir = getenv("XDG_RUNTIME_DIR"); runtimeDir && *runtimeDir) {
+        return std::filesystem::path(runtimeDir) / "dmz.sock";
+    }
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / ("dmz-" + std::to_string(getuid()));
+    if (!private_directory(directory)) return {};
+    return directory / "dmz.sock";
+}
+
+std::optional<int> run_client(const CompilerOptions &options) {
+    debug_func("");
+    std::filesystem::path path = socket_path(options);
+    sockaddr_un address;
+    if (path.empty() || !make_address(path, address)) return std::nullopt;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) return std::nullopt;
+    defer([&] { close(fd); });
+    if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == -1) return std::nullopt;
+    if (!same_user(fd)) {
+        std::cerr << "warning: the compile server on '" << path.string()
+                  << "' belongs to another user, compiling locally\n";
+        return std::nullopt;
+    }
+
+    // The working directory followed by the arguments without the client ones
+    std::vector<std::string> strings = {std::filesystem::current_path().string()};
+    for (size_t i = 0; i < options.arguments.size(); i++) {
+        if (options.arguments[i] == "-client") continue;
+        if (options.arguments[i] == "-socket") {
+            i++;
+            continue;
+        }
+        strings.emplace_back(options.arguments[i]);
+    }
+    std::string payload;
+    for (auto &&str : strings) {
+        uint32_t size = str.size();
+        payload.append(reinterpret_cast<const char *>(&size), sizeof(size));
+        payload += str;
+    }
+
+    if (!send_request_header(fd, payload.size())) return std::nullopt;
+    if (!write_all(fd, payload.data(), payload.size())) return std::nullopt;
+
+    int32_t ret;
+    if (!read_all(fd, &ret, sizeof(ret))) {
+        std::cerr << "error: the compile server closed the connection\n";
+        return EXIT_FAILURE;
+    }
+    return ret;
+}
+
+CompileServer::CompileServer(CompilerOptions options) : m_options(std::move(options)) {}
+
+int CompileServer::run() {
+    debug_func("");
+    // Every request is compiled in a fork, the server cannot have worker threads
+    Driver::instance().reset(CompilerOptions{});
+    signal(SIGPIPE, SIG_IGN);
+
+    std::filesystem::path path = socket_path(m_options);
+    if (path.empty()) error("cannot create a private directory for the socket, use -socket <path>");
+    sockaddr_un address;
+    if (!make_address(path, address)) error("socket path too long '" + path.string() + "'");
+
+    m_socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_socket == -1) {
+        perror("socket");
+        return EXIT_FAILURE;
+    }
+    if (connect(m_socket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0) {
+        error("a compile server is already listening on '" + path.string() + "'");
+    }
+    // The socket left by a server that did not exit cleanly
+    unlink(path.c_str());
+    if (bind(m_socket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == -1 || listen(m_socket, 16) == -1) {
+        perror("bind");
+        close(m_socket);
+        return EXIT_FAILURE;
+    }
+    defer([&] {
+        close(m_socket);
+        unlink(path.c_str());
+    });
+    std::cerr << "dmz compile server listening on " << path.string() << std::endl;
+
+    while (true) {
+        int connection = accept4(m_socket, nullptr, nullptr, SOCK_CLOEXEC);
+        if (connection == -1) {
+            if (errno == EINTR) continue;
+            perror("accept");
+            return EXIT_FAILURE;
+        }
+        // A client that stops sending does not block the server, its request is dropped
+        timeval timeout = {.tv_sec = requestTimeout, .tv_usec = 0};
+        setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        if (same_user(connection)) handle_request(connection);
+        close(connection);
+    }
+}
+
+void CompileServer::handle_request(int connection) {
+    debug_func("");
+    uint32_t size;
+    int fds[3];
+    if (!receive_request_header(connection, size, fds)) return;
+    defer([&] {
+        for (int fd : fds) close(fd);
+    });
+    if (size > maxRequestSize) return;
+
+    std::string payload(size, '\0');
+    if (!read_all(connection, payload.data(), size)) return;
+    std::vector<std::string> strings;
+    for (size_t pos = 0; pos + sizeof(uint32_t) <= payload.size();) {
+        uint32_t len;
+        memcpy(&len, payload.data() + pos, sizeof(len));
+        pos += sizeof(len);
+        if (pos + len > payload.size()) return;
+        strings.emplace_back(payload.substr(pos, len));
+        pos += len;
+    }
+    if (strings.empty()) return;
+
+    int32_t ret = EXIT_FAILURE;
+    std::filesystem::path workingDir = strings[0];
+    std::vector<std::string> arguments(strings.begin() + 1, strings.end());
+
+    // The child sends through the pipe the source and the imports of valid arguments, so the server can parse them
+    // without exiting on invalid ones
+    int ready[2];
+    if (pipe2(ready, O_CLOEXEC) == -1) {
+        perror("pipe");
+        write_all(connection, &ret, sizeof(ret));
+        return;
+    }
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork");
+        close(ready[0]);
+        close(ready[1]);
+        write_all(connection, &ret, sizeof(ret));
+        return;
+    } else if (pid == 0) {
+        // child, only it moves to the working directory of the client
+        close(m_socket);
+        close(connection);
+        close(ready[0]);
+        for (int i = 0; i < 3; i++) {
+            dup2(fds[i], i);
+        }
+        if (chdir(workingDir.c_str()) == -1) {
+            perror("chdir");
+            std::exit(EXIT_FAILURE);
+        }
+        std::exit(compile(arguments, ready[1]));
+    }
+
+    // parent
+    close(ready[1]);
+    int status;
+    waitpid(pid, &status, 0);
+    ret = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    write_all(connection, &ret, sizeof(ret));
+
+    std::string request;
+    char buffer[4096];
+    for (ssize_t readed; (readed = read(ready[0], buffer, sizeof(buffer))) != 0;) {
+        if (readed == -1 && errno == EINTR) continue;
+        if (readed == -1) break;
+        request.append(buffer, readed);
+    }
+    close(ready[0]);
+    std::vector<std::string> paths;
+    for (size_t pos = 0; pos < request.size();) {
+        size_t end = request.find('\0', pos);
+        if (end == std::string::npos) break;
+        paths.emplace_back(request.substr(pos, end - pos));
+        pos = end + 1;
+    }
+    if (paths.empty() || paths.size() % 2 == 0) return;
+
+    // With the client served, parse what the request imported for the next ones
+    CompilerOptions options;
+    options.source = paths[0];
+    for (size_t i = 1; i + 1 < paths.size(); i += 2) {
+        options.imports.emplace(paths[i], paths[i + 1]);
+    }
+    warm_up(options, workingDir);
+}
+
+int CompileServer::compile(const std::vector<std::string> &arguments, int readyFd) {
+    debug_func("");
+    std::vector<char *> argv = {const_cast<char *>("dmz")};
+    for (auto &&arg : arguments) {
+        argv.emplace_back(const_cast<char *>(arg.c_str()));
+    }
+    CompilerOptions options = CompilerOptions::parse_arguments(argv.size(), argv.data());
+    // The arguments are valid, the absolute source and the imports follow, ended by zeros
+    std::string request = std::filesystem::absolute(options.source).string() + '\0';
+    for (auto &&[k, v] : options.imports) {
+        request += k + '\0' + v.string() + '\0';
+    }
+    write_all(readyFd, request.data(), request.size());
+    close(readyFd);
+    options.serve = false;
+    options.client = false;
+
+    invalidate_imports(options, std::filesystem::current_path());
+    auto &d = Driver::instance();
+    d.reset(std::move(options));
+    d.pruneImports = true;
+    return d.main();
+}
+
+void CompileServer::invalidate_imports(const CompilerOptions &options, const std::filesystem::path &workingDir) {
+    debug_func("");
+    auto &d = Driver::instance();
+    std::filesystem::path projectDir = std::filesystem::absolute(workingDir / options.source).parent_path();
+    if (options.imports != m_imports || projectDir != m_projectDir || workingDir != m_workingDir) {
+        d.imported_modules.clear();
+        d.module_imports.clear();
+        m_stamps.clear();
+        m_imports = options.imports;
+        m_projectDir = projectDir;
+        m_workingDir = workingDir;
+        return;
+    }
+
+    d.module_imports.erase(options.source);
+    for (auto &&[path, ast] : d.imported_modules) {
+        if (!ast) continue;
+        std::error_code ec;
+        auto stamp = m_stamps.find(path);
+        if (stamp == m_stamps.end() || std::filesystem::last_write_time(path, ec) != stamp->second || ec) {
+            debug_msg("changed module " << path);
+            ast = nullptr;
+            d.module_imports.erase(path);
+            m_stamps.erase(path);
+        }
+    }
+}
+
+void CompileServer::warm_up(const CompilerOptions &options, const std::filesystem::path &workingDir) {
+    debug_func("");
+    if (options.source.extension() != ".dmz" || !std::filesystem::exists(options.source)) return;
+
+    invalidate_imports(options, workingDir);
+
+    // std is found in the working directory of the client when it is not imported nor next to the source
+    CompilerOptions warmUpOptions = options;
+    auto stdPath = workingDir / "std" / "std.dmz";
+    bool stdNextToSource = std::filesystem::exists(options.source.parent_path() / "std" / "std.dmz");
+    if (!options.imports.contains("std") && !stdNextToSource && std::filesystem::exists(stdPath)) {
+        warmUpOptions.imports.emplace("std", std::filesystem::canonical(stdPath));
+    }
+
+    auto &d = Driver::instance();
+    d.reset(std::move(warmUpOptions));
+    d.pruneImports = false;
+    auto start = std::filesystem::file_time_type::clock::now();
+
+    // The diagnostics were already reported to the client
+    int devNull = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    int savedStderr = dup(STDERR_FILENO);
+    dup2(devNull, STDERR_FILENO);
+    try {
+        auto lexer = d.lexer_pass(d.m_options.source);
+        auto ast = d.parser_pass(std::move(lexer));
+        if (ast) d.import_pass(ast);
+    } catch (const std::exception &) {
+    }
+    dup2(savedStderr, STDERR_FILENO);
+    close(savedStderr);
+    close(devNull);
+
+    // A module edited while it was parsed keeps no stamp, so it is parsed again by the next request
+    for (auto &&[path, ast] : d.imported_modules) {
+        if (!ast || m_stamps.contains(path)) continue;
+        std::error_code ec;
+        auto time = std::filesystem::last_write_time(path, ec);
+        if (!ec && time < start) m_stamps[path] = time;
+    }
+}
+}  // namespace DMZ::server
@@ -1,6 +1,11 @@
 #include "test_runner/test_runner.hpp"
 
+#include <fcntl.h>
 #include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/socket.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
@@ -8,18 +13,28 @@
 #include <array>
 #include <atomic>
 #include <chrono>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <sstream>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "Debug.hpp"
+#include "cache/Cache.hpp"
+#include "driver/Driver.hpp"
+
+extern char** environ;
 
 namespace fs = std::filesystem;
 
@@ -37,6 +52,15 @@ struct TestCase {
     fs::path path;
     std::vector<std::string> run_lines;
     std::vector<CheckDirective> checks;
+    // Hash of the compiler and of the files the test reads
+    std::string key;
+};
+
+// Last result of a test, in the results file of the cache
+struct CachedResult {
+    std::string key;
+    bool success;
+    double elapsed;
 };
 
 struct ExecResult {
@@ -83,6 +107,327 @@ ExecResult exec(const std::string& cmd) {
     return {result, status};
 }
 
+// Exit code of `timeout` when the command runs out of time
+static constexpr int timeout_exit_code = 124;
+
+// Characters with a meaning for the shell, the commands without them are split in words and spawned directly
+static constexpr std::string_view shell_chars = "|&;<>()$`\\\"'*?[]{}~#!";
+
+// The words of a command that does not need the shell, a trailing `2>&1` merges stderr into the output
+static std::optional<std::vector<std::string>> simple_command(std::string cmd, bool& merge_stderr) {
+    merge_stderr = false;
+    std::string_view redirect = " 2>&1";
+    if (cmd.ends_with(redirect)) {
+        cmd.resize(cmd.size() - redirect.size());
+        merge_stderr = true;
+    }
+    if (cmd.find_first_of(shell_chars) != std::string::npos) return std::nullopt;
+
+    std::vector<std::string> args;
+    std::stringstream ss(cmd);
+    std::string word;
+    while (ss >> word) args.emplace_back(word);
+    // Variable assignments before the command are left to the shell
+    if (args.empty() || args[0].find('=') != std::string::npos) return std::nullopt;
+    return args;
+}
+
+// Like exec with `timeout`, without the processes of the shell and of timeout
+ExecResult spawn(const std::vector<std::string>& args, bool merge_stderr, std::chrono::milliseconds timeout) {
+    debug_msg("Command to spawn: '" << args[0] << "'");
+    int fds[2];
+    // Close on exec so the pipe of a test is not inherited by the commands of the other workers
+    if (pipe2(fds, O_CLOEXEC) != 0) throw std::runtime_error("pipe() failed!");
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    if (merge_stderr) posix_spawn_file_actions_adddup2(&actions, fds[1], STDERR_FILENO);
+
+    std::vector<char*> argv;
+    for (auto&& arg : args) argv.emplace_back(const_cast<char*>(arg.c_str()));
+    argv.emplace_back(nullptr);
+
+    pid_t pid;
+    int err = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[1]);
+    if (err != 0) {
+        close(fds[0]);
+        // The same as the shell when the command cannot be executed
+        return {args[0] + ": " + strerror(err) + "\n", 127 << 8};
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    auto remaining = [&] {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        return std::max<int>(left.count(), 0);
+    };
+
+    std::string result;
+    std::array<char, 4096> buffer;
+    bool timed_out = false;
+    pollfd pfd = {.fd = fds[0], .events = POLLIN, .revents = 0};
+    while (true) {
+        int ready = poll(&pfd, 1, remaining());
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready <= 0) {
+            timed_out = true;
+            break;
+        }
+        ssize_t count = read(fds[0], buffer.data(), buffer.size());
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) break;
+        result.append(buffer.data(), count);
+    }
+    close(fds[0]);
+
+    int status = 0;
+    while (!timed_out) {
+        pid_t ret = waitpid(pid, &status, WNOHANG);
+        if (ret == pid || (ret < 0 && errno != EINTR)) break;
+        if (remaining() == 0) {
+            timed_out = true;
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (timed_out) {
+        kill(pid, SIGKILL);
+        waitpid(pid, &status, 0);
+        return {result, timeout_exit_code << 8};
+    }
+    // The exit code that the shell gives to a command killed by a signal
+    if (WIFSIGNALED(status)) status = (128 + WTERMSIG(status)) << 8;
+    return {result, status};
+}
+
+static bool write_all(int fd, const void* data, size_t size) {
+    const char* buffer = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = write(fd, buffer, size);
+        if (written == -1 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        buffer += written;
+        size -= written;
+    }
+    return true;
+}
+
+// Reads size bytes before the deadline, false on a timeout or the end of the pipe
+static bool read_until(int fd, void* data, size_t size, std::chrono::steady_clock::time_point deadline,
+                       bool& timed_out) {
+    char* buffer = static_cast<char*>(data);
+    pollfd pfd = {.fd = fd, .events = POLLIN, .revents = 0};
+    while (size > 0) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        int ready = poll(&pfd, 1, std::max<int>(left.count(), 0));
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready <= 0) {
+            timed_out = true;
+            return false;
+        }
+        ssize_t count = read(fd, buffer, size);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return false;
+        buffer += count;
+        size -= count;
+    }
+    return true;
+}
+
+// Process forked from the runner before its workers start, with the targets of llvm initialized, that forks the
+// compilers of the RUN lines instead of executing the compiler again for each one.
+// A request is one message with the arguments and the pipes of the output and of the status. The server forks a
+// leader of a new process group for it, which writes its pid to the status pipe, forks the compiler and writes its
+// wait status when it ends. The runner kills the whole group on a timeout.
+class ForkServer {
+   public:
+    bool start() {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) == -1) return false;
+        // The server cannot have threads, the compilers forked from it start their own
+        Driver::instance().reset(CompilerOptions{});
+        std::cout.flush();
+        std::cerr.flush();
+        m_pid = fork();
+        if (m_pid == -1) {
+            close(fds[0]);
+            close(fds[1]);
+            return false;
+        }
+        if (m_pid == 0) {
+            close(fds[0]);
+                serve(fds[1]);
+        }
+        close(fds[1]);
+        m_socket = fds[0];
+        return true;
+    }
+
+    void stop() {
+        if (m_socket == -1) return;
+        close(m_socket);
+        waitpid(m_pid, nullptr, 0);
+        m_socket = -1;
+    }
+
+    // Nothing when the server cannot take the request, the command is spawned then
+    std::optional<ExecResult> run(const std::vector<std::string>& args, bool merge_stderr,
+                                  std::chrono::milliseconds timeout) {
+        if (m_socket == -1) return std::nullopt;
+        int out[2], status[2];
+        if (pipe2(out, O_CLOEXEC) != 0) return std::nullopt;
+        if (pipe2(status, O_CLOEXEC) != 0) {
+            close(out[0]);
+            close(out[1]);
+            return std::nullopt;
+        }
+        defer([&] {
+            close(out[0]);
+            close(status[0]);
+        });
+
+        // The arguments after the compiler, each one ended by a zero, and the stderr flag
+        std::string payload;
+        for (size_t i = 1; i < args.size(); i++) {
+            payload += args[i];
+            payload += '\0';
+        }
+        payload += merge_stderr ? '1' : '0';
+        bool sent = send_request(payload, {out[1], status[1]});
+        close(out[1]);
+        close(status[1]);
+        if (!sent) return std::nullopt;
+
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        bool timed_out = false;
+        pid_t leader;
+        if (!read_until(status[0], &leader, sizeof(leader), deadline, timed_out)) return std::nullopt;
+
+        std::string result;
+        std::array<char, 4096> buffer;
+        pollfd pfd = {.fd = out[0], .events = POLLIN, .revents = 0};
+        while (!timed_out) {
+            auto left =
+                std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            int ready = poll(&pfd, 1, std::max<int>(left.count(), 0));
+            if (ready < 0 && errno == EINTR) continue;
+            if (ready <= 0) {
+                timed_out = true;
+                break;
+            }
+            ssize_t count = read(out[0], buffer.data(), buffer.size());
+            if (count < 0 && errno == EINTR) continue;
+            if (count <= 0) break;
+            result.append(buffer.data(), count);
+        }
+
+        int wstatus = 0;
+        if (!timed_out && !read_until(status[0], &wstatus, sizeof(wstatus), deadline, timed_out) && !timed_out) {
+            // The leader died without the status of the compiler
+            return ExecResult{result, EXIT_FAILURE << 8};
+        }
+        if (timed_out) {
+            kill(-leader, SIGKILL);
+            return ExecResult{result, timeout_exit_code << 8};
+        }
+        // The exit code that the shell gives to a command killed by a signal
+        if (WIFSIGNALED(wstatus)) wstatus = (128 + WTERMSIG(wstatus)) << 8;
+        return ExecResult{result, wstatus};
+    }
+
+   private:
+    int m_socket = -1;
+    pid_t m_pid = -1;
+
+    bool send_request(const std::string& payload, std::array<int, 2> fds) {
+        iovec iov = {const_cast<char*>(payload.data()), payload.size()};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))] = {};
+        msghdr msg = {};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+        memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(fds));
+        return sendmsg(m_socket, &msg, MSG_NOSIGNAL) == static_cast<ssize_t>(payload.size());
+    }
+
+    [[noreturn]] static void serve(int socket) {
+        // The leaders are not waited, the runner reads their status from the pipe
+        signal(SIGCHLD, SIG_IGN);
+        Driver::instance().ptrBitSize();
+        Driver::instance().target_simd_size();
+
+        std::vector<char> payload(1 << 16);
+        while (true) {
+            std::array<int, 2> fds;
+            iovec iov = {payload.data(), payload.size()};
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))] = {};
+            msghdr msg = {};
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            ssize_t size = recvmsg(socket, &msg, MSG_CMSG_CLOEXEC);
+            if (size < 0 && errno == EINTR) continue;
+            // The runner closed its end
+            if (size <= 0) _exit(EXIT_SUCCESS);
+
+            cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+            if (!cmsg || cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN(sizeof(fds))) continue;
+            memcpy(fds.data(), CMSG_DATA(cmsg), sizeof(fds));
+            if ((msg.msg_flags & MSG_TRUNC) == 0 && fork() == 0) {
+                close(socket);
+                lead(std::string(payload.data(), size), fds[0], fds[1]);
+            }
+            close(fds[0]);
+            close(fds[1]);
+        }
+    }
+
+    [[noreturn]] static void lead(const std::string& payload, int out, int status) {
+        setpgid(0, 0);
+        signal(SIGCHLD, SIG_DFL);
+        pid_t self = getpid();
+        write_all(status, &self, sizeof(self));
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            dup2(out, STDOUT_FILENO);
+            if (payload.back() == '1') dup2(out, STDERR_FILENO);
+            close(out);
+            close(status);
+            compile(payload.substr(0, payload.size() - 1));
+        }
+        close(out);
+        int wstatus = EXIT_FAILURE << 8;
+        if (pid != -1) waitpid(pid, &wstatus, 0);
+        write_all(status, &wstatus, sizeof(wstatus));
+        _exit(EXIT_SUCCESS);
+    }
+
+    [[noreturn]] static void compile(const std::string& arguments) {
+        std::vector<std::string> strings;
+        for (size_t pos = 0; pos < arguments.size();) {
+            size_t end = arguments.find('\0', pos);
+            strings.emplace_back(arguments.substr(pos, end - pos));
+            pos = end + 1;
+        }
+        std::vector<char*> argv = {const_cast<char*>("dmz")};
+        for (auto&& arg : strings) argv.emplace_back(const_cast<char*>(arg.c_str()));
+
+        auto& d = Driver::instance();
+        d.reset(CompilerOptions::parse_arguments(argv.size(), argv.data()));
+        std::exit(d.main());
+    }
+};
+
 static void trim(std::string& s) {
     if (s.empty()) return;
     s.erase(0, s.find_first_not_of(" \t\r\n"));
@@ -274,7 +619,104 @@ static std::string process_line_vars(std::string pat, int line_num) {
     return pat;
 }
 
-TestResult perform_test(const std::string& dmz_bin, const TestCase& tc) {
+static std::string to_hex(uint64_t value) {
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << value;
+    return ss.str();
+}
+
+// Path, size and modification time, enough to tell two builds of the compiler apart
+static uint64_t binary_hash(const std::string& dmz_bin) {
+    std::error_code ec;
+    std::string identity = dmz_bin;
+    identity += ":" + std::to_string(fs::file_size(dmz_bin, ec));
+    identity += ":" + std::to_string(fs::last_write_time(dmz_bin, ec).time_since_epoch().count());
+    return hash_fnv1a(identity);
+}
+
+// Modules imported by a dmz file with a relative path, the ones found through -I are named in the RUN lines
+static std::vector<fs::path> imported_files(const fs::path& file) {
+    std::vector<fs::path> imports;
+    std::ifstream in(file);
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::string_view prefix = "import(\"";
+    for (size_t pos = content.find(prefix); pos != std::string::npos; pos = content.find(prefix, pos)) {
+        pos += prefix.size();
+        size_t end = content.find('"', pos);
+        if (end == std::string::npos) break;
+        std::string imported = content.substr(pos, end - pos);
+        if (imported.ends_with(".dmz")) imports.emplace_back(file.parent_path() / imported);
+    }
+    return imports;
+}
+
+// Hash of the compiler, the test, the files named in its RUN lines and the modules all of them import
+static std::string test_key(const TestCase& tc, uint64_t compiler) {
+    std::string abs_dir = fs::absolute(tc.path.parent_path()).string();
+    std::vector<fs::path> inputs = {tc.path};
+    for (auto&& line : tc.run_lines) {
+        std::string cmd = replace_all(line, "%S", abs_dir);
+        for (char& c : cmd) {
+            if (std::string_view("()<>|;&'\"").find(c) != std::string_view::npos) c = ' ';
+        }
+        std::stringstream ss(cmd);
+        std::string word;
+        while (ss >> word) {
+            std::error_code ec;
+            if (word.find('/') != std::string::npos && fs::is_regular_file(word, ec)) inputs.emplace_back(word);
+        }
+    }
+
+    uint64_t hash = hash_fnv1a(to_hex(compiler));
+    std::unordered_set<std::string> visited;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        std::error_code ec;
+        fs::path input = fs::weakly_canonical(inputs[i], ec);
+        if (!visited.emplace(input.string()).second) continue;
+        hash = hash_fnv1a(input.string(), hash);
+        hash = hash_fnv1a(to_hex(Cache::hash_file(input).value_or(0)), hash);
+        if (input.extension() != ".dmz") continue;
+        for (auto&& imported : imported_files(input)) inputs.emplace_back(imported);
+    }
+    return to_hex(hash);
+}
+
+// One line per test: path, key, 1 when it passed and the seconds it took
+static std::unordered_map<std::string, CachedResult> load_results(const fs::path& path) {
+    std::unordered_map<std::string, CachedResult> results;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string test, key;
+        int success;
+        double elapsed;
+        if (std::getline(ss, test, '\t') && ss >> key >> success >> elapsed) {
+            results[test] = {key, success == 1, elapsed};
+        }
+    }
+    return results;
+}
+
+static void store_results(const fs::path& path, const std::unordered_map<std::string, CachedResult>& results) {
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+    std::map<std::string, CachedResult> sorted(results.begin(), results.end());
+    // Written aside and renamed, so a runner that is reading it never sees half of the file
+    fs::path tmp = path;
+    tmp += "." + std::to_string(getpid());
+    {
+        std::ofstream file(tmp);
+        if (!file) return;
+        for (auto&& [test, result] : sorted) {
+            file << test << '\t' << result.key << ' ' << result.success << ' ' << std::fixed << std::setprecision(3)
+                 << result.elapsed << '\n';
+        }
+    }
+    fs::rename(tmp, path, ec);
+}
+
+TestResult perform_test(const std::string& dmz_bin, const TestCase& tc, ForkServer& server) {
     auto start = std::chrono::high_resolution_clock::now();
     try {
         if (tc.run_lines.empty()) {
@@ -329,11 +771,19 @@ TestResult perform_test(const std::string& dmz_bin, const TestCase& tc) {
 
             if (should_check && cmd.find("2>&1") == std::string::npos) cmd += " 2>&1";
 
-            std::string escaped_cmd = cmd;
-            escaped_cmd = replace_all(escaped_cmd, "\"", "\\\"");
-            escaped_cmd = replace_all(escaped_cmd, "$", "\\$");
-            std::string full_cmd = "timeout 1s bash -c \"" + escaped_cmd + "\"";
-            ExecResult res = exec(full_cmd);
+            ExecResult res;
+            bool merge_stderr;
+            if (auto args = simple_command(cmd, merge_stderr)) {
+                std::optional<ExecResult> served;
+                if ((*args)[0] == dmz_bin) served = server.run(*args, merge_stderr, std::chrono::seconds(1));
+                res = served ? std::move(*served) : spawn(*args, merge_stderr, std::chrono::seconds(1));
+            } else {
+                std::string escaped_cmd = cmd;
+                escaped_cmd = replace_all(escaped_cmd, "\"", "\\\"");
+                escaped_cmd = replace_all(escaped_cmd, "$", "\\$");
+                std::string full_cmd = "timeout 1s bash -c \"" + escaped_cmd + "\"";
+                res = exec(full_cmd);
+            }
             int exit_code = WEXITSTATUS(res.status);
 
             if (should_check) {
@@ -349,7 +799,7 @@ TestResult perform_test(const std::string& dmz_bin, const TestCase& tc) {
             } else if (exit_code != 0) {
                 auto end = std::chrono::high_resolution_clock::now();
                 std::chrono::duration<double> elapsed = end - start;
-                if (exit_code == 124) return {false, tc.path.string(), elapsed.count(), {}, "TIMEOUT", res.output};
+                if (exit_code == timeout_exit_code) return {false, tc.path.string(), elapsed.count(), {}, "TIMEOUT", res.output};
                 std::vector<std::string> errors;
                 errors.push_back("Command failed with exit code " + std::to_string(exit_code));
                 errors.push_back("Command: " + cmd);
@@ -380,7 +830,7 @@ int run_tests(std::string_view test_path, const TestOptions& options) {
 
     std::vector<TestCase> tests;
     auto process_file = [&](const fs::path& p) {
-        if (p.extension() == ".dmz") {
+        if (p.extension() == ".dmz" && p.string().find(options.filter) != std::string::npos) {
             TestCase tc;
             tc.path = p;
             std::ifstream file(p);
@@ -425,13 +875,45 @@ int run_tests(std::string_view test_path, const TestOptions& options) {
     std::mutex output_mutex;
     std::mutex queue_mutex;
     std::queue<size_t> test_queue;
-    for (size_t i = 0; i < tests.size(); ++i) test_queue.push(i);
-
     std::atomic<int> passed(0);
+    int cached = 0;
+
+    // The tests that passed with the same inputs are not run again, the others start by the slowest last time so the
+    // long ones do not run alone at the end. The new tests go first, they could be long.
+    auto results = options.cache_file.empty() ? std::unordered_map<std::string, CachedResult>{}
+                                              : load_results(options.cache_file);
+    uint64_t compiler = binary_hash(dmz_bin);
+    std::vector<std::pair<double, size_t>> pending;
+    for (size_t i = 0; i < tests.size(); ++i) {
+        tests[i].key = test_key(tests[i], compiler);
+        auto it = results.find(fs::absolute(tests[i].path).string());
+        if (it == results.end() || it->second.key != tests[i].key) {
+            pending.emplace_back(std::numeric_limits<double>::max(), i);
+            continue;
+        }
+        if (it->second.success && !options.force) {
+            passed++;
+            cached++;
+            if (!options.quiet) {
+                std::cout << "Running test: " << tests[i].path.string() << "... " << "\033[32mPASSED\033[0m (cached)"
+                          << std::endl;
+            }
+            continue;
+        }
+        pending.emplace_back(it->second.elapsed, i);
+    }
+    std::stable_sort(pending.begin(), pending.end(), [](auto& a, auto& b) { return a.first > b.first; });
+    for (auto&& [elapsed, i] : pending) test_queue.push(i);
+
     int num_workers = options.parallel_jobs;
     if (num_workers <= 0) num_workers = std::thread::hardware_concurrency();
     if (num_workers <= 0) num_workers = 1;
 
+    // The compilers of the tests are forked from a server started before the workers, without the start up of a new
+    // process
+    ForkServer server;
+    if (!test_queue.empty() && get_executable_path() == dmz_bin) server.start();
+
     auto worker_task = [&] {
         while (true) {
             size_t test_idx;
@@ -441,9 +923,11 @@ int run_tests(std::string_view test_path, const TestOptions& options) {
                 test_idx = test_queue.front();
                 test_queue.pop();
             }
-            auto result = perform_test(dmz_bin, tests[test_idx]);
+            auto result = perform_test(dmz_bin, tests[test_idx], server);
             {
                 std::lock_guard<std::mutex> lock(output_mutex);
+                results[fs::absolute(tests[test_idx].path).string()] = {tests[test_idx].key, result.success,
+                                                                          result.elapsed};
                 if (result.success) {
                     passed++;
                     if (!options.quiet)
@@ -477,11 +961,15 @@ int run_tests(std::string_view test_path, const TestOptions& options) {
         for (int i = 0; i < num_workers; ++i) workers.emplace_back(worker_task);
         for (auto& w : workers) w.join();
     }
+    server.stop();
+
+    if (!options.cache_file.empty()) store_results(options.cache_file, results);
 
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> elapsed = end - start;
-    std::cout << "\nSummary: " << passed << "/" << tests.size() << " tests passed in " << std::fixed
-              << std::setprecision(3) << elapsed.count() << " seconds" << std::endl;
+    std::cout << "\nSummary: " << passed << "/" << tests.size() << " tests passed";
+    if (cached > 0) std::cout << " (" << cached << " cached)";
+    std::cout << " in " << std::fixed << std::setprecision(3) << elapsed.count() << " seconds" << std::endl;
     return (passed == (int)tests.size()) ? 0 : 1;
 }
 